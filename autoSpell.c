@@ -0,0 +1,4791 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <getopt.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <arpa/inet.h>
+#include <errno.h>
+#include <limits.h>
+#include <signal.h>
+#include <pthread.h>
+#include "autospell.h"
+#if defined(__GNUC__) && ( defined(__x86_64__) || defined(__i386__) )
+#include <immintrin.h>
+#define HAVE_X86_SIMD 1
+#endif
+
+#define MAXL 30
+
+#if MAXL != AUTOSPELL_MAXL
+#error "AUTOSPELL_MAXL in autospell.h must be MAXL"
+#endif
+
+#define DELIMITERS " .,?!\';\n:-()\"\t"   // the characters that separate words
+
+#define LANES 32                  // dictionary words per block of a transposed bucket (one AVX2 register of bytes)
+
+#define MIN3(a, b, c) ((a) < (b) ? ((a) < (c) ? (a) : (c)) : ((b) < (c) ? (b) : (c)))
+
+struct bkNode                     // one node of a BK-tree; node i of the tree is dictionary word i
+{
+   long int child;                // index of the first child of this node (-1 if none)
+   long int sibling;              // index of the next child of this node's parent (-1 if none)
+   int dist;                      // edit distance between this word and its parent's word
+};
+
+struct trieNode                   // one node of the trie of the dictionary words (ocr index, DAWG source)
+{
+   long int child;                // index of the first child of this node (-1 if none)
+   long int sibling;              // index of the next child of this node's parent (-1 if none)
+   long int word;                 // the dictionary word that ends here (-1 if none)
+   unsigned char c;               // the narrow character of this node
+};
+
+struct confusionTable;
+
+struct exactIndex                 // hash table of the dictionary words (see the exact word table)
+{
+   unsigned int *slots;           // index + 1 of a dictionary word (0 marks an empty slot)
+   unsigned long int mask;        // number of slots - 1
+};
+
+struct dawgNode                   // one node of the DAWG (node 0 stands for none)
+{
+   unsigned int child;            // the first node of the list below this one
+   unsigned int sibling;          // the next node of the list this one is in
+   unsigned int words;            // words ending at this node, below it and at and below the rest of its list
+   unsigned int lengths;          // bit k: a word ends k characters below this node or one of the rest of its list
+   unsigned char c;               // the narrow character
+   unsigned char final;           // a word ends at this node
+};
+
+struct symSlot                    // one slot of the hash table of the symmetric-delete or hole index
+{
+   unsigned long long key;        // hash of a deletion variant (0 marks an empty slot)
+   unsigned int first;            // index in posting[] of the first word having that deletion variant
+   unsigned int count;            // number of words having that deletion variant
+};
+
+struct symIndex                   // symmetric-delete (SymSpell style) index over the dictionary; also the hole index
+{
+   struct symSlot *slots;         // open addressing hash table, a power of two in size
+   unsigned long int mask;        // number of slots - 1
+   unsigned int *posting;         // dictionary word indexes grouped by key, ascending within a group
+   unsigned long int numPostings;
+};
+
+enum indexMode { INDEX_SCAN, INDEX_BK, INDEX_SYM, INDEX_HOLE, INDEX_TRIE, INDEX_DAWG };
+
+enum kernel { KERNEL_BIT, KERNEL_DP, KERNEL_SIMD };
+
+enum matcher { MATCHER_LEV, MATCHER_SIM, MATCHER_OCR };
+
+struct transposedBucket           // the words of one length stored character position major for the SIMD kernels
+{
+   unsigned char *chars;          // chars[(block * len + pos) * LANES + lane] = character pos of word start + block * LANES + lane
+   long int start;                // index in the dictionary of the first word
+   long int count;                // number of words transposed (lanes past count in the last block are 0)
+};
+
+typedef void (*levBlockFn)( const char *word, const int len, const unsigned char *block, unsigned char *dist );
+
+struct searchIndex                // how returnWord finds the candidates in a length bucket
+{
+   enum matcher matcher;          // option --matcher
+   enum indexMode mode;
+   enum kernel kernel;            // option -k
+   levBlockFn levBlock;           // AVX2 or SSE4.2 block kernel picked at run time (-k simd)
+   struct transposedBucket transposed[MAXL + 1];
+   struct bkNode *bkTree;         // one node per dictionary word (mode INDEX_BK)
+   struct symIndex sym;           // mode INDEX_SYM
+   struct symIndex hole;          // mode INDEX_HOLE (the sim matcher's index, keyed by hole signatures)
+   struct trieNode *trie;         // mode INDEX_TRIE (the ocr matcher's index)
+   long int trieNodes;
+   struct confusionTable *confusions;   // the ocr matcher's costs
+   struct dawgNode *dawg;         // mode INDEX_DAWG: the minimized graph of the words ...
+   unsigned long int dawgNodes;   // ... of this many nodes (node 0 included)
+   unsigned int dawgRoot;         // its first node
+   unsigned int *dawgWord;        // dictionary index of each word by its number in the DAWG
+   unsigned long int dawgWords;   // words in the DAWG (the dictionary without its repeats)
+   struct exactIndex exact;       // every dictionary word, so returnWord need not search for one
+};
+
+/*  -=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+    autoSpell - a non-interactive spelling text correction program
+    Copyright (C) 2016  Perry T Jennings
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Any similarity of the name of this program to another program not written by this author is coincidental and unintended and does not indicate or imply an association.
+
+usage: autoSpell [--matcher lev|sim|ocr] [--confusions file] [-i bk|sym|hole|dawg|scan] [-k bit|dp|simd] [-c cache_file] [-m] [-j threads] [--stats[=json]] [-o output_file [--manifest file [--resume]]] text_file_to_correct dictionary
+       autoSpell [--matcher lev|sim|ocr] [-i bk|sym|hole|dawg|scan] compile-dict dictionary image
+       autoSpell [--matcher lev|sim|ocr] [--confusions file] [-i bk|sym|hole|dawg|scan] [-k bit|dp|simd] [-c cache_file] [-j threads] serve dictionary socket
+       autoSpell [--words] client socket text_file_to_correct
+purpose: to non-interactively correct some spelling mistakes (such as in a text file produced by optical
+character recognition - ocr)
+output is to standard output.
+In other words this program takes a text file with spelling errors and prints to standard output the same text with some spelling corrections.  It does not interactively ask you to select or approve the changes since a word of seven or more characters with one or two wrong characters most likely is misspelled and has a high probability of being matched to just one correct word.  Beside, with an ocr text you are going to have to manually scan through the whole file anyway for possible ocr mistakes and garbled text.  This program is intended to save time and labor with at least the larger words.
+
+below are the program parameters the user may change, but give careful thought before you do:
+
+MAXL 		is maximum characters for a word.  Words are counted in characters, not bytes, in utf-8
+ 		  texts (see the characters), as are minCharWord and the maxED tiers
+minCharWord   	the minimum number characters in a word to search for similar words
+		(smaller words are simply printed out without searching for replacement);
+		7 for the lev matcher, 9 for sim
+
+The dictionary (the second argument to this program) must be a single column of words sorted from shortest
+to longest.  It is adviseable to also secondarily sort the words such that words of the same length 
+are sorted from most frequent to least.  There is no limit on the number of words; words longer than MAXL are
+skipped since input words that long are printed without being searched for.  The dictionary and the text are
+utf-8 (a list in another 8 bit encoding, such as Latin-1, also works if the text is in the same one); the list may
+be sorted by the length in characters or in bytes.  At most 127 different non-ASCII characters may appear in the
+dictionary (enough for accented Latin or for modern Greek, not for both or for polytonic Greek): a dictionary with
+more is refused with exit code -3.
+Each word may be followed on its line by its count in a body of text ("word 1234", the frequency column that
+make_word_list.sh gives, see how_to_create_a_dictionary).  The words of each length are then put in order of
+frequency when the list is read, so it need only be sorted by length, and of the words equally near to an input
+word the most frequent is taken.  Frequent words come first in the length buckets, so an exact match ends a scan
+sooner.
+
+--matcher lev   (default) a word is replaced by the first (most frequent) dictionary word of the same length
+                nearest to it by Levenshtein edit distance, if that is at most maxED (1, 2 or 3 by word length)
+--matcher sim   a word is replaced by the first dictionary word of the same length or one character shorter
+                that differs from it by one character or a pair of adjacent characters (function simWords)
+--matcher ocr   a word is replaced by the dictionary word (of any length) of least edit cost to it, if that is
+                within the budget for its length, where the edits ocr makes often (rn for m, tt for u, c for e)
+                cost less than the others.  The costs are read from --confusions file, else built in; see
+                the ocr matcher.  The dictionary is searched through a trie whatever -i says.
+          When the program is installed (or linked) under the name autoSpellSim the default is sim, so the
+          two original programs can still be run by their names.  -k applies to the lev matcher only.
+
+-i bk     (default) search each word length of the dictionary through a BK-tree built when the dictionary
+          is read.  The tree is a metric tree over the Levenshtein distance so whole branches that cannot hold
+          a word within maxED of the input word are never visited.  The result is the same as with -i scan.
+-i sym    precompute every deletion variant (up to maxED deletions) of each dictionary word into a hash table.
+          A lookup is then a few hash probes for the deletions of the input word and levenshtein is run only on
+          the words that share one.  Takes much more memory and time to build than the BK-tree; the build time
+          and memory used are reported on standard error.  The result is the same as with -i scan.
+-i hole   (the default with --matcher sim) index every dictionary word by its hole signatures: the word with
+          one pair of adjacent characters replaced by a hole, and the word with one character replaced by a
+          hole that also stands for the character after it.  An input word of n characters then needs only
+          2(n-1) hash probes and simWords is run on the few words found.  The result is the same as with
+          -i scan.  With --matcher lev, -i hole means -i bk; with --matcher sim, -i bk and -i sym mean -i hole.
+-i dawg   keep the dictionary as a minimized DAWG (a trie whose identical subtrees, such as the endings shared by
+          many Latin words, are stored once) and walk it with the Levenshtein DP row of the input word, leaving a
+          branch once it can hold no word of the input word's length within maxED.  The work grows with the
+          number of near words rather than the size of the bucket.  The node count and memory are reported on
+          standard error.  The result is the same as with -i scan.  With --matcher sim it means -i hole.
+-i scan   compare the input word with every dictionary word of the same length (the original method)
+
+-k bit    (default) compute edit distances with the bit-parallel kernel levenshteinBits.  Its bitmasks for the
+          input word are made once per input word and a candidate is abandoned as soon as it cannot beat the
+          best distance found so far.
+-k dp     compute edit distances with the original column by column function levenshtein (the reference)
+-k simd   with -i scan, score the input word against 32 dictionary words at a time, one per byte lane of a vector
+          register, using AVX2 or else SSE4.2 as the processor allows.  It reads a copy of each length bucket
+          stored character position major that is made when the dictionary is read.  The other index modes
+          (or a processor without either) use the bit-parallel kernel.
+
+-c file   keep a cache of corrections in file: each input word is looked up there before any search and the
+          results of new searches are added to it when the program ends.  The cache is tied to the dictionary
+          and the matching settings (the matcher, minCharWord, the maxED tiers, the confusion table) and is
+          started afresh if they change.
+
+-m        map the whole text file into memory instead of reading it in blocks.  Words and delimiters are
+          then printed straight from the mapping and only the words that are searched for are copied.  Falls
+          back to reading blocks if the file cannot be mapped (a pipe for instance).
+
+-j N      correct with N threads.  The text (mapped, or else each block read) is cut into chunks of whole lines
+          which the threads correct against the shared dictionary; the chunks are printed in their original
+          order so the output and the number of corrections are the same as with one thread.
+
+text_file_to_correct may be - for standard input, so the program can sit in a pipeline:
+          pdftotext book.pdf - | autoSpell - dictionary | less
+          The text is read (and corrected and printed) a block of 1 MB (for each thread) at a time, so the memory
+          used does not grow with the length of the text.  The same is done with a file unless -m or -j map it.
+
+-o file   write the corrected text to file instead of standard output.
+
+--manifest file
+          (with -o) correct a mapped text file in blocks of whole lines, writing the output to output_file.part and
+          after each block a line about it (where it is in the text and the output, their hashes and its
+          corrections) to file.part, which are renamed to output_file and file at the end.  A run that is stopped
+          can then be carried on with --resume instead of starting again, and a later run over the text after a
+          small edit copies the output of every block that did not change from the previous output_file and
+          corrects only the others.  The manifest is tied to the dictionary and the matching settings as the cache
+          is; see the manifest.
+--resume  with --manifest, keep what output_file.part and file.part hold of an interrupted run (the blocks that
+          still match the text and whose output is intact) and go on from there.
+
+--stats[=json]
+          when the text is done, report on standard error what happened to its words: how many there were and
+          how many were too short or too long to search, the calls of returnWord and how many were found in the
+          dictionary (and so not searched) or answered by the cache, the dictionary words compared per search,
+          the exact matches and corrections, what the searches found (by edit distance, or identical / similar /
+          none for sim), the index used (its size, and the seconds spent building it if the dictionary image did not
+          hold it) and the seconds spent loading the dictionary, finding the words, searching and printing.  --stats=json prints the same as one line of JSON.  The
+          counters are always kept (each thread its own); the clock is only read with --stats.
+
+compile-dict dictionary image
+          read the word list dictionary and write it to the file image in a binary form that is mapped straight
+          into memory when image is later given as the dictionary (with either matcher), which saves reading the
+          word list and building the index at every start.  The index chosen with -i (the BK-tree, the
+          symmetric-delete table, the hole index or the DAWG) is stored with the words; a run with another -i builds its own index at start
+          up as usual.  The format is described at writeDictImage; an image is only readable by a build with
+          the same MAXL on a machine of the same byte order.
+
+serve dictionary socket
+          read the dictionary and build its index once, then correct the texts that clients send to the Unix
+          domain socket socket until SIGINT or SIGTERM, when the socket is removed (and the cache saved with -c).
+          -j N serves N connections at a time (default one for each processor); a connection that is idle for
+          DAEMON_IDLE_SECONDS is closed.  Each request costs only its correction, so many short texts (a
+          page at a time from an ocr pipeline) do not each pay for reading the dictionary.
+client socket text_file_to_correct
+          send the text (or - for standard input) to the daemon and print the corrected text; the return code is
+          the same as if autoSpell had corrected the text itself.  With --words the text is a list of words, one a
+          line, each corrected as a whole and printed one a line.  The protocol is described above serveDaemon; -8 is
+          returned if the daemon cannot be reached.
+
+The same code is a library for other programs (see autospell.h, which also tells how to build it): a dictionary
+is opened once and words, lists of words or whole buffers are then corrected with it from any number of threads.
+This program is itself built on it.
+
+The author concurrently wrote two similar programs - autoSpellSim and autoSpellLev - which are now the two
+matchers of this one. 
+Their purpose was to non-interactively and automatically correct a large number of
+ocr mistakes in a 4.5M text file.  It was observed that most errors are of the form
+decernamtts vs. decernamus (ocr made tt from u) or constarc vs. constare (transposition).
+autoSpellSim was written to find and correct these errors.
+Then the author discovered the concept of edit distance and various tools and theories of
+fuzzy searching and spell checking.  The other program autoSpellLev uses the well-known
+Levenshtein algorithm.
+
+future work: capital letters outside ASCII, Latin-1, Latin Extended-A, Greek and Cyrillic keep their case
+when searched, so such a word at the start of a sentence costs an edit.
+
+Perry  res_emptito@yahoo.com
+-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= */
+
+/***************************** the dictionary arena ******************************/
+
+/* The dictionary words are kept end to end, each followed by its '\0', in one arena that grows as the word list
+   is read, so the memory used is that of the words themselves and the words of a length bucket lie next to each
+   other.  offset[i] is where word i starts; offset[numWords] is the end of the last word, so the length of word i
+   is offset[i + 1] - offset[i] - 1. */
+
+struct dictionary
+{
+   char *arena;
+   unsigned int *offset;          // numWords + 1 entries
+   long int numWords;
+   size_t arenaSize;              // bytes of arena in use
+   size_t arenaCap;               // bytes of arena allocated
+   long int offsetCap;            // entries of offset allocated
+   unsigned int wide[127];        // wide[b - NARROW_FIRST] is the character of the narrow byte b (see narrowWord)
+   int numWide;                   // narrow bytes in use
+   unsigned int narrowKey[256];   // hash table of the characters in wide[] (0 for an empty slot) ...
+   unsigned char narrowValue[256];  // ... and their narrow bytes
+   unsigned int *freq;            // the frequency column, one count per word (NULL if the list has none)
+};
+
+/***************************** function dictWord ******************************/
+
+static const char *dictWord ( const struct dictionary *dict, const long int i )
+{
+   // function to return word i of the dictionary (null-terminated)
+   return dict->arena + dict->offset[i];
+}
+
+/***************************** function dictLength ******************************/
+
+static int dictLength ( const struct dictionary *dict, const long int i )
+{
+   // function to return the number of characters of word i of the dictionary
+   return (int) ( dict->offset[i + 1] - dict->offset[i] - 1 );
+}
+
+/***************************** function rankedBefore ******************************/
+
+static _Bool rankedBefore ( const struct dictionary *dict, const long int a, const long int b )
+{
+   /* function to return true if dictionary word a is to be preferred to word b at the same distance: the more
+      frequent if the list has a frequency column, else (and at the same frequency) the first */
+
+   if ( dict->freq && dict->freq[a] != dict->freq[b] )
+      return (_Bool) ( dict->freq[a] > dict->freq[b] );
+   return (_Bool) ( a < b );
+}
+
+/***************************** the characters ******************************/
+
+/* Texts and dictionaries are UTF-8.  A word is measured, searched and compared in characters, not bytes: each of
+   the (at most 127; a dictionary with more is refused) different non-ASCII characters of the dictionary is given a byte of its own from 128 up as the
+   dictionary is read, and the words are kept in that narrow form, one byte a character.  So every kernel, index
+   and the cache work on the narrow words as they did on ASCII, and a pure ASCII word is its own narrow form.  An
+   input word is narrowed by narrowWord before it is searched (a character the dictionary does not have becomes
+   NARROW_OTHER, which matches nothing) and a correction is turned back into UTF-8 by widenWord.  A byte that is not
+   part of valid UTF-8 is a character of its own (U+DC80 + its low 7 bits, as Python's surrogateescape), so a
+   Latin-1 text with a Latin-1 dictionary is still corrected byte by byte. */
+
+#define MAXB ( 4 * MAXL )          // most bytes of a word of MAXL characters
+#define NARROW_FIRST 128           // the narrow byte of the first non-ASCII character of the dictionary
+#define NARROW_OTHER 255           // the narrow byte of any character not in the dictionary
+
+/***************************** function utf8Next ******************************/
+
+static unsigned int utf8Next ( const unsigned char *s, const size_t len, size_t *i )
+{
+   /* function to return the character (code point) that starts at s[*i] and move *i past it.  Overlong forms,
+      surrogates and cut off sequences are not valid: their first byte b is returned alone as 0xDC00 + b. */
+
+   unsigned int b = s[*i], cp, need, min;
+   size_t k;
+
+   if ( b < 0x80 )
+   {
+      ( *i )++;
+      return b;
+   }
+   if ( b >= 0xC2 && b <= 0xDF )
+      need = 1, cp = b & 0x1F, min = 0x80;
+   else if ( b >= 0xE0 && b <= 0xEF )
+      need = 2, cp = b & 0x0F, min = 0x800;
+   else if ( b >= 0xF0 && b <= 0xF4 )
+      need = 3, cp = b & 0x07, min = 0x10000;
+   else
+      need = 0, cp = 0, min = 1;
+   for ( k = 1; k <= need && *i + k < len && ( s[*i + k] & 0xC0 ) == 0x80; k++ )
+      cp = ( cp << 6 ) | ( s[*i + k] & 0x3F );
+   if ( need == 0 || k <= need || cp < min || cp > 0x10FFFF || ( cp >= 0xD800 && cp <= 0xDFFF ) )
+   {
+      ( *i )++;
+      return 0xDC00 + b;
+   }
+   *i += k;
+   return cp;
+}
+
+/***************************** function charCount ******************************/
+
+static size_t charCount ( const char *s, const size_t len )
+{
+   // function to return the number of characters in the len bytes of s
+
+   size_t i = 0, n = 0;
+
+   while ( i < len )
+   {
+      if ( (unsigned char) s[i] < 0x80 )
+         i++;
+      else
+         (void) utf8Next( (const unsigned char *) s, len, &i );
+      n++;
+   }
+   return n;
+}
+
+/***************************** function isAscii ******************************/
+
+static _Bool isAscii ( const char *buf, const size_t len )
+{
+   /* function to tell whether the len bytes of buf are all ASCII, so that each word in them is as many characters
+      as bytes.  16 bytes are tested at a time with SSE2, else 8 at a time. */
+
+   size_t k = 0;
+   unsigned long long w;
+
+#if defined(HAVE_X86_SIMD) && defined(__SSE2__)
+   for ( ; k + 16 <= len; k += 16 )
+      if ( _mm_movemask_epi8( _mm_loadu_si128( (const __m128i *) ( buf + k ) ) ) != 0 )
+         return (_Bool) 0;
+#endif
+   for ( ; k + 8 <= len; k += 8 )
+   {
+      memcpy( &w, buf + k, 8 );
+      if ( w & 0x8080808080808080ULL )
+         return (_Bool) 0;
+   }
+   for ( ; k < len; k++ )
+      if ( (unsigned char) buf[k] >= 0x80 )
+         return (_Bool) 0;
+   return (_Bool) 1;
+}
+
+/***************************** functions lowerCase and upperCase ******************************/
+
+static unsigned int lowerCase ( const unsigned int cp )
+{
+   // function to return the small letter of the capital letter cp (of Latin-1, Latin Extended-A, Greek or Cyrillic)
+
+   if ( cp < 0x80 )
+      return (unsigned int) tolower( (int) cp );
+   if ( ( cp >= 0xC0 && cp <= 0xDE && cp != 0xD7 ) || ( cp >= 0x391 && cp <= 0x3AB && cp != 0x3A2 )
+        || ( cp >= 0x410 && cp <= 0x42F ) )
+      return cp + 0x20;
+   if ( ( cp >= 0x100 && cp <= 0x137 ) || ( cp >= 0x14A && cp <= 0x177 ) )
+      return cp | 1;
+   if ( ( cp >= 0x139 && cp <= 0x148 ) || ( cp >= 0x179 && cp <= 0x17E ) )
+      return cp & 1 ? cp + 1 : cp;
+   if ( cp == 0x178 )
+      return 0xFF;
+   if ( cp == 0x386 )
+      return 0x3AC;
+   if ( cp >= 0x388 && cp <= 0x38A )
+      return cp + 0x25;
+   if ( cp == 0x38C )
+      return 0x3CC;
+   if ( cp == 0x38E || cp == 0x38F )
+      return cp + 0x3F;
+   if ( cp >= 0x400 && cp <= 0x40F )
+      return cp + 0x50;
+   return cp;
+}
+
+static unsigned int upperCase ( const unsigned int cp )
+{
+   // function to return the capital letter of the small letter cp; the reverse of lowerCase
+
+   if ( cp < 0x80 )
+      return (unsigned int) toupper( (int) cp );
+   if ( ( cp >= 0xE0 && cp <= 0xFE && cp != 0xF7 ) || ( cp >= 0x3B1 && cp <= 0x3CB && cp != 0x3C2 )
+        || ( cp >= 0x430 && cp <= 0x44F ) )
+      return cp - 0x20;
+   if ( ( cp >= 0x100 && cp <= 0x137 ) || ( cp >= 0x14A && cp <= 0x177 ) )
+      return cp & ~1U;
+   if ( ( cp >= 0x139 && cp <= 0x148 ) || ( cp >= 0x179 && cp <= 0x17E ) )
+      return cp & 1 ? cp : cp - 1;
+   if ( cp == 0xFF )
+      return 0x178;
+   if ( cp == 0x3AC )
+      return 0x386;
+   if ( cp >= 0x3AD && cp <= 0x3AF )
+      return cp - 0x25;
+   if ( cp == 0x3CC )
+      return 0x38C;
+   if ( cp == 0x3CD || cp == 0x3CE )
+      return cp - 0x3F;
+   if ( cp >= 0x450 && cp <= 0x45F )
+      return cp - 0x50;
+   return cp;
+}
+
+/***************************** functions narrowFind and narrowAdd ******************************/
+
+static unsigned char narrowFind ( const struct dictionary *dict, const unsigned int cp )
+{
+   // function to return the narrow byte of the non-ASCII character cp, or NARROW_OTHER if the dictionary has none
+
+   unsigned int h = ( cp * 2654435761U ) >> 24;
+
+   while ( dict->narrowKey[h] != 0 && dict->narrowKey[h] != cp )
+      h = ( h + 1 ) & 255;
+   return dict->narrowKey[h] == cp ? dict->narrowValue[h] : NARROW_OTHER;
+}
+
+static unsigned char narrowAdd ( struct dictionary *dict, const unsigned int cp )
+{
+   /* function to return the narrow byte of the non-ASCII character cp, giving it the next free one if it has none
+      yet; 0 if all are taken */
+
+   unsigned int h = ( cp * 2654435761U ) >> 24;
+
+   while ( dict->narrowKey[h] != 0 && dict->narrowKey[h] != cp )
+      h = ( h + 1 ) & 255;
+   if ( dict->narrowKey[h] == cp )
+      return dict->narrowValue[h];
+   if ( dict->numWide == NARROW_OTHER - NARROW_FIRST )
+      return 0;
+   dict->narrowKey[h] = cp;
+   dict->narrowValue[h] = (unsigned char) ( NARROW_FIRST + dict->numWide );
+   dict->wide[dict->numWide++] = cp;
+   return dict->narrowValue[h];
+}
+
+/***************************** function narrowWord ******************************/
+
+static int narrowWord ( const struct dictionary *dict, const char *word, const size_t len, char *narrow,
+                        _Bool *capitalized )
+{
+   /* function to write to narrow (room for MAXL + 1) the len bytes of word in the narrow form of the dictionary,
+      with its first letter made small if it is a capital (then *capitalized is set), and return its number of
+      characters, or -1 if that is more than MAXL */
+
+   const unsigned char *s = (const unsigned char *) word;
+   size_t i = 0;
+   unsigned int cp;
+   int n = 0;
+
+   *capitalized = (_Bool) 0;
+   while ( i < len )
+   {
+      if ( n == MAXL )
+         return -1;
+      cp = s[i] < 0x80 ? s[i++] : utf8Next( s, len, &i );
+      if ( n == 0 && lowerCase( cp ) != cp )
+      {
+         cp = lowerCase( cp );
+         *capitalized = (_Bool) 1;
+      }
+      else if ( n == 0 && cp < 0x80 )        // the first character is not a small letter (as the original test)
+         *capitalized = (_Bool) ( cp == (unsigned int) toupper( (int) cp ) );
+      narrow[n++] = cp < 0x80 ? (char) cp : (char) narrowFind( dict, cp );
+   }
+   narrow[n] = '\0';
+   return n;
+}
+
+/***************************** function widenWord ******************************/
+
+static void widenWord ( const struct dictionary *dict, const char *narrow, char *out, const _Bool capitalized )
+{
+   // function to write to out (room for MAXB + 1) the dictionary word narrow in UTF-8, capitalized if asked
+
+   const unsigned char *s = (const unsigned char *) narrow;
+   unsigned int cp;
+
+   for ( ; *s; s++ )
+   {
+      cp = *s < NARROW_FIRST ? *s : dict->wide[*s - NARROW_FIRST];
+      if ( capitalized && s == (const unsigned char *) narrow )
+         cp = upperCase( cp );
+      if ( cp < 0x80 )
+         *out++ = (char) cp;
+      else if ( cp >= 0xDC80 && cp <= 0xDCFF )           // a byte of no valid UTF-8, as it was
+         *out++ = (char) ( cp - 0xDC00 );
+      else if ( cp < 0x800 )
+      {
+         *out++ = (char) ( 0xC0 | ( cp >> 6 ) );
+         *out++ = (char) ( 0x80 | ( cp & 0x3F ) );
+      }
+      else if ( cp < 0x10000 )
+      {
+         *out++ = (char) ( 0xE0 | ( cp >> 12 ) );
+         *out++ = (char) ( 0x80 | ( ( cp >> 6 ) & 0x3F ) );
+         *out++ = (char) ( 0x80 | ( cp & 0x3F ) );
+      }
+      else
+      {
+         *out++ = (char) ( 0xF0 | ( cp >> 18 ) );
+         *out++ = (char) ( 0x80 | ( ( cp >> 12 ) & 0x3F ) );
+         *out++ = (char) ( 0x80 | ( ( cp >> 6 ) & 0x3F ) );
+         *out++ = (char) ( 0x80 | ( cp & 0x3F ) );
+      }
+   }
+   *out = '\0';
+}
+
+/***************************** function readDictWord ******************************/
+
+static long int readDictWord ( FILE *wordList, struct dictionary *dict, long long *count )
+{
+   /* function to read the next white space separated word of wordList onto the end of the arena, without a limit
+      on its length, and return its length.  If the word is followed on its line by a number, that is its count
+      (the frequency column) and goes to *count, else *count is -1.  The word is not entered in offset[]: the
+      caller does that by increasing numWords, or drops it by leaving numWords alone.  Returns -1 at the end of
+      wordList and -2 if memory ran out. */
+
+   size_t start;
+   int c;
+   char *grown;
+   unsigned int *grownOffset;
+
+   if ( dict->numWords + 2 > dict->offsetCap )
+   {
+      if ( ( grownOffset = realloc( dict->offset, ( dict->offsetCap ? 2 * dict->offsetCap : 1 << 16 )
+                                                  * sizeof( *dict->offset ) ) ) == NULL )
+         return -2;
+      dict->offset = grownOffset;
+      if ( dict->freq != NULL )
+      {
+         if ( ( grownOffset = realloc( dict->freq, ( dict->offsetCap ? 2 * dict->offsetCap : 1 << 16 )
+                                                   * sizeof( *dict->freq ) ) ) == NULL )
+            return -2;
+         dict->freq = grownOffset;
+      }
+      dict->offsetCap = dict->offsetCap ? 2 * dict->offsetCap : 1 << 16;
+   }
+   if ( dict->numWords == 0 )
+      dict->offset[0] = 0;
+   dict->arenaSize = dict->offset[dict->numWords];           // forget a word read but not entered
+   while ( ( c = getc( wordList ) ) != EOF && isspace( c ) )
+      ;
+   if ( c == EOF )
+      return -1;
+   start = dict->arenaSize;
+   do
+   {
+      if ( dict->arenaSize + 1 >= dict->arenaCap )           // room for c and the final '\0'
+      {
+         if ( ( grown = realloc( dict->arena, dict->arenaCap ? 2 * dict->arenaCap : 1 << 20 ) ) == NULL )
+            return -2;
+         dict->arena = grown;
+         dict->arenaCap = dict->arenaCap ? 2 * dict->arenaCap : 1 << 20;
+      }
+      dict->arena[dict->arenaSize++] = (char) c;
+   }
+   while ( ( c = getc( wordList ) ) != EOF && ! isspace( c ) );
+   dict->arena[dict->arenaSize++] = '\0';
+   *count = -1;
+   while ( c == ' ' || c == '\t' )
+      c = getc( wordList );
+   if ( c != EOF && isdigit( c ) )
+      for ( *count = 0; c != EOF && isdigit( c ); c = getc( wordList ) )
+         if ( ( *count = *count * 10 + ( c - '0' ) ) > 0xffffffffLL )
+            *count = 0xffffffffLL;
+   if ( c != EOF )
+      ungetc( c, wordList );
+   if ( dict->arenaSize > 0xffffffffUL )                     // offsets are 32 bit
+      return -2;
+   dict->offset[dict->numWords + 1] = (unsigned int) dict->arenaSize;
+   return (long int) ( dict->arenaSize - start - 1 );
+}
+
+/***************************** function makeDelimTable ******************************/
+
+static void makeDelimTable ( unsigned char delimTable[256], const char *delimiters )
+{
+   // function to fill the lookup table used by nextToken: delimTable[c] is 1 if c is one of the delimiters
+
+   memset( delimTable, 0, 256 );
+   for ( ; *delimiters; delimiters++ )
+      delimTable[(unsigned char) *delimiters] = 1;
+}
+
+/***************************** function nextToken ******************************/
+
+struct tokenSpan                  // a run of delimiters or a word found by nextToken in a buffer
+{
+   size_t offset;                 // where the run starts in the buffer
+   size_t length;                 // number of bytes in the run
+   _Bool isWord;                  // false for a run of delimiters
+};
+
+static _Bool nextToken ( const unsigned char delimTable[256], const char *buf, const size_t bufLen, size_t *cursor,
+                         struct tokenSpan *span )
+{
+   /* function to find the run starting at *cursor in buf: the longest run of bytes that are all delimiters or all
+      not delimiters (a word).  The run is described in *span (nothing is copied) and *cursor moves past it.
+      Returns false when *cursor is at the end of buf.  Each byte is looked at once, so a whole line costs O(n). */
+
+   size_t k = *cursor;
+   unsigned char isDelim;
+
+   if ( k >= bufLen )
+      return (_Bool) 0;
+   isDelim = delimTable[(unsigned char) buf[k]];
+   while ( k < bufLen && delimTable[(unsigned char) buf[k]] == isDelim )
+      k++;
+   span->offset = *cursor;
+   span->length = k - *cursor;
+   span->isWord = (_Bool) !isDelim;
+   *cursor = k;
+   return (_Bool) 1;
+}
+
+/***************************** the run statistics ******************************/
+
+/* --stats counts what happens to the words of the text.  Each thread counts into its own threadStats, so the
+   counters need no locking, and the counts of the worker threads are added up when they finish.  The counters are
+   a few additions per word (one per bucket scan, not one per dictionary word) and are kept whether or not --stats
+   is given; only the clock is read just when it is. */
+
+struct runStats
+{
+   long int words;                // words found in the text
+   long int shortWords;           // words not searched for being shorter than minCharWord
+   long int longWords;            // words not searched for being longer than the longest dictionary word (or MAXL)
+   long int calls;                // calls of returnWord
+   long int cacheHits;            // words returnWord found in the correction cache
+   long int members;              // words returnWord found in the dictionary (see the exact word table)
+   long int searches;             // words searched by searchLev or searchSim
+   long int comparisons;          // dictionary words scored by levenshtein, levenshteinBits or simWords
+   long int found[MAXL + 2];      /* searches by what they found; lev: found[d] the best word is at edit distance d,
+                                     found[MAXL + 1] no word within maxED (ocr: the cost in plain edits, rounded up);
+                                     sim: found[r] the simWords result r */
+   double tokenizeTime;           // seconds (added up over the threads) spent in nextToken
+   double searchTime;             // in returnWord
+   double outputTime;             // writing the words and delimiters
+};
+
+static _Thread_local struct runStats threadStats;
+
+/***************************** function statsAdd ******************************/
+
+#ifndef AUTOSPELL_NO_MAIN                  // only main and its threads add up the statistics
+
+static void statsAdd ( struct runStats *to, const struct runStats *from )
+{
+   int k;
+
+   to->words += from->words;
+   to->shortWords += from->shortWords;
+   to->longWords += from->longWords;
+   to->calls += from->calls;
+   to->cacheHits += from->cacheHits;
+   to->members += from->members;
+   to->searches += from->searches;
+   to->comparisons += from->comparisons;
+   for ( k = 0; k <= MAXL + 1; k++ )
+      to->found[k] += from->found[k];
+   to->tokenizeTime += from->tokenizeTime;
+   to->searchTime += from->searchTime;
+   to->outputTime += from->outputTime;
+}
+
+#endif /* AUTOSPELL_NO_MAIN */
+
+/***************************** function statsLap ******************************/
+
+static void statsLap ( double *time, struct timespec *last )
+{
+   // function to add to *time the seconds since *last and make now the new *last
+
+   struct timespec now;
+
+   clock_gettime( CLOCK_MONOTONIC, &now );
+   *time += (double) ( now.tv_sec - last->tv_sec ) + (double) ( now.tv_nsec - last->tv_nsec ) / 1e9;
+   *last = now;
+}
+
+/***************************** function levenshtein ******************************/
+
+static int levenshtein(const char *s1, const char *s2)
+
+/*
+Purpose of this function is to return the Levenshtein "distance" between two words which is an indication of their similarity.
+Taken from https://en.wikibooks.org/wiki/Algorithm_Implementation/Strings/Levenshtein_distance#C
+*/
+
+{
+    unsigned int s1len, s2len, x, y, lastdiag, olddiag;
+    s1len = (unsigned int) strlen(s1);
+    s2len = (unsigned int) strlen(s2);
+    unsigned int column[s1len+1];
+    for (y = 1; y <= s1len; y++)
+        column[y] = y;
+    for (x = 1; x <= s2len; x++) {
+        column[0] = x;
+        for (y = 1, lastdiag = x-1; y <= s1len; y++) {
+            olddiag = column[y];
+            column[y] = MIN3(column[y] + 1, column[y-1] + 1, lastdiag + (s1[y-1] == s2[x-1] ? 0 : 1));
+            lastdiag = olddiag;
+        }
+    }
+    return(column[s1len]);
+}
+
+/***************************** function simWords ******************************/
+
+static int simWords (const char *testWord, const char *trueWord)
+
+/*
+   Purpose of this function is for use in automatically correcting ocr misspellings with what would be
+   assumed the most likely match.  Words are "similar" as used in this function if the testWord is
+   0 or 1 characters longer than trueWord AND all the letters in testWord that match letters in trueWord
+   are in the same sequence AND the two words differ by one character or a pair of adjacent characters.
+
+return values:
+0 - not similar
+1 - words are similar
+2 - words are identical match
+
+It is probably not prudent to use testWord with less than 4, 5 or maybe 6 characters as the similarity
+is not as reliable as with longer words.
+*/
+
+{
+   /* The answer depends only on where the two words first and last differ.  p is the length of their common
+      prefix and s that of their common suffix (matching from the ends of both words), each at most the length
+      of trueWord, so a single pass from each end is enough and nothing is copied.
+
+      Same length n: similar if all the differing positions fit within one adjacent pair j, j+1 (or the one
+      position of a 1 character word), that is if n - p - s <= 2.
+
+      testWord one longer (n = m + 1): similar if for some j in 0..m-1 testWord without its pair j, j+1 equals
+      trueWord without its character j.  That needs the first j characters to agree (j <= p) and the last m-1-j
+      to agree (m-1-j <= s), and there is such a j if m >= 1 and p + s >= m - 1. */
+
+   int len_testWord = (int) strlen(testWord);
+   int len_trueWord = (int) strlen(trueWord);
+   int diffchar = len_testWord - len_trueWord;
+   int p = 0, s = 0;
+
+   if (diffchar != 0 && diffchar != 1)
+      return 0;
+
+   while (p < len_trueWord && testWord[p] == trueWord[p])
+      p++;
+   if (diffchar == 0 && p == len_testWord) //words are identical
+      return 2;
+   while (s < len_trueWord && testWord[len_testWord - 1 - s] == trueWord[len_trueWord - 1 - s])
+      s++;
+
+   if (diffchar == 0) //e.g. constarc vs. constare
+      return len_testWord - p - s <= 2;
+   //testWord is one character longer than trueWord e.g. decernamtts vs. decernamus
+   return len_trueWord >= 1 && p + s >= len_trueWord - 1;
+}
+
+/***************************** function levPrepare ******************************/
+
+struct levPattern                 // a word made ready for levenshteinBits
+{
+   unsigned long long peq[256];   // bit y of peq[c] is set when word[y] == c
+   const char *word;
+   int len;
+};
+
+static void levPrepare ( struct levPattern *pattern, const char *word )
+{
+   // function to fill in the character bitmasks of word (at most MAXL < 64 characters) for levenshteinBits
+
+   int y;
+
+   memset( pattern->peq, 0, sizeof( pattern->peq ) );
+   pattern->word = word;
+   pattern->len = (int) strlen( word );
+   for ( y = 0; y < pattern->len; y++ )
+      pattern->peq[(unsigned char) word[y]] |= 1ULL << y;
+}
+
+/***************************** function levenshteinBits ******************************/
+
+static int levenshteinBits ( const struct levPattern *pattern, const char *text, const int bound )
+
+/*
+Purpose of this function is to return the same Levenshtein distance as function levenshtein between the
+prepared pattern word and text, or any value >= bound as soon as the distance is sure to be at least bound.
+It is the bit-vector algorithm of Myers (1999) in the form given by Hyyro (2001): one machine word holds the
+vertical differences of a whole DP column, so each character of text costs a few logical operations instead of
+a loop over the pattern.  The score is the last row of the column; after x of the n characters of text the final
+distance cannot be less than score - (n - x), which is what lets a hopeless candidate be dropped early.
+*/
+
+{
+   unsigned long long pv, mv, ph, mh, xv, xh, eq, last;
+   int n = (int) strlen( text );
+   int score = pattern->len;
+   int x;
+
+   if ( pattern->len == 0 )
+      return n;
+   last = 1ULL << ( pattern->len - 1 );                     // the bit of the last row
+   pv = ~0ULL;
+   mv = 0;
+   for ( x = 0; x < n; x++ )
+   {
+      eq = pattern->peq[(unsigned char) text[x]];
+      xv = eq | mv;
+      xh = ( ( ( eq & pv ) + pv ) ^ pv ) | eq;
+      ph = mv | ~( xh | pv );
+      mh = pv & xh;
+      if ( ph & last )
+         score++;
+      else if ( mh & last )
+         score--;
+      if ( score - ( n - x - 1 ) >= bound )
+         return bound;
+      ph = ( ph << 1 ) | 1;                                  // row 0 of the DP grows by one per character of text
+      mh = mh << 1;
+      pv = mh | ~( xv | ph );
+      mv = ph & xv;
+   }
+   return score;
+}
+
+/***************************** function wordDistance ******************************/
+
+static int wordDistance ( const struct searchIndex *index, const struct levPattern *pattern, const char *word,
+                          const int bound )
+{
+   // function to return the edit distance between the prepared pattern and word with the kernel chosen by -k
+
+   if ( index->kernel == KERNEL_DP )
+      return levenshtein( pattern->word, word );
+   return levenshteinBits( pattern, word, bound );
+}
+
+/***************************** function maxEdits ******************************/
+
+static int maxEdits ( const int wordLen )
+{
+   // function to return the maximum permissible edit distance for a word of wordLen characters to match
+
+   if ( wordLen <= 7 )
+      return 1;
+   else if ( wordLen <= 13 )
+      return 2;
+   else
+      return 3;
+}
+
+/***************************** function bucketEnd ******************************/
+
+static long int bucketEnd ( const long int *wordLenIndex, const int wordLen )
+{
+   /* function to return the last index in the dictionary of the words with wordLen characters (of the words
+      shorter than that if there are none of wordLen characters) */
+
+   long int endIndex;
+   int k;
+   int i = wordLen + 1;
+
+   if ( i <= MAXL && wordLenIndex[i] != 0 )
+      return wordLenIndex[i] - 1;                            // the usual case: last (highest) index for words of same length
+   endIndex = wordLenIndex[0] - 1;
+   for ( k = MAXL; k > i; k-- )
+      if ( wordLenIndex[k] )
+         endIndex = wordLenIndex[k] - 1;
+   return endIndex;
+}
+
+/***************************** the bucket scans ******************************/
+
+struct matchQuery                 // the input word as the bucket scans want it
+{
+   const char *word;
+   const struct levPattern *pattern;   // word made ready for levenshteinBits (lev matcher only)
+   int enough;                    /* a score no later word can beat: an exact match (0, or 2 for simWords), or the
+                                     next best (1) once returnWord knows word is not in the dictionary */
+};
+
+/* BUCKET_SCAN( name, SCORE, BETTER, DONE ) defines the function name which scores the dictionary words
+   i..endIndex against the query q in dictionary order and returns the index of the first word whose score
+   beats *best (and puts its score in *best), or -1 if none does.  The words scored are added to
+   threadStats.comparisons once at the end.  Each matcher's scoring is written into its own
+   copy of the loop rather than called through a pointer for every candidate, so the compiler can inline it:
+      SCORE( q, w, best )      the score of dictionary word w; may give up early once it cannot beat best
+      BETTER( score, best )    true if score beats best
+      DONE( q, best )          true if no word can beat best, which ends the scan */
+
+#define BUCKET_SCAN( name, SCORE, BETTER, DONE )                                                           \
+static long int name ( const struct matchQuery *q, const struct dictionary *dict, long int i,                  \
+                       const long int endIndex, int *best )                                                    \
+{                                                                                                              \
+   long int bestIndex = -1;                                                                                    \
+   long int first = i;                                                                                         \
+   int score;                                                                                                  \
+                                                                                                               \
+   for ( ; i <= endIndex && ! DONE( q, *best ); i++ )                                                          \
+   {                                                                                                           \
+      score = SCORE( q, dictWord( dict, i ), *best );                                                          \
+      if ( BETTER( score, *best ) )                                                                            \
+      {                                                                                                        \
+         bestIndex = i;                                                                                        \
+         *best = score;                                                                                        \
+      }                                                                                                        \
+   }                                                                                                           \
+   if ( i > first )                                                                                            \
+      threadStats.comparisons += i - first;                                                                    \
+   return bestIndex;                                                                                           \
+}
+
+#define LEV_BIT_SCORE( q, w, best )      levenshteinBits( (q)->pattern, w, best )
+#define LEV_DP_SCORE( q, w, best )       levenshtein( (q)->word, w )
+#define SIM_SCORE( q, w, best )          simWords( (q)->word, w )
+#define FEWER( score, best )             ( (score) < (best) )
+#define MORE( score, best )              ( (score) > (best) )
+#define LEV_DONE( q, best )              ( (best) <= (q)->enough )   // an exact match (or see enough)
+#define SIM_DONE( q, best )              ( (best) >= (q)->enough )   // an identical word (or see enough)
+
+BUCKET_SCAN( scanLevBit, LEV_BIT_SCORE, FEWER, LEV_DONE )
+BUCKET_SCAN( scanLevDp, LEV_DP_SCORE, FEWER, LEV_DONE )
+BUCKET_SCAN( scanSim, SIM_SCORE, MORE, SIM_DONE )
+
+/***************************** functions levBlockAvx2 and levBlockSse ******************************/
+
+/* These functions return in dist[0..LANES-1] the Levenshtein distance between word (len characters) and each of
+   the LANES words of len characters in one block of a transposed bucket.  They run the same column by column DP as
+   function levenshtein with one byte lane per dictionary word, so row y of the column is a vector holding the
+   entries of all the words.  Distances never exceed MAXL + 1 so bytes are wide enough. */
+
+#ifdef HAVE_X86_SIMD
+__attribute__(( target( "avx2" ) ))
+static void levBlockAvx2 ( const char *word, const int len, const unsigned char *block, unsigned char *dist )
+{
+   // function to fill dist with the distances of word to the LANES words of block, 32 lanes at a time
+
+   __m256i column[MAXL + 1];
+   __m256i lastdiag, olddiag, text, cost;
+   const __m256i one = _mm256_set1_epi8( 1 );
+   int x, y;
+
+   for ( y = 0; y <= len; y++ )
+      column[y] = _mm256_set1_epi8( (char) y );
+   for ( x = 1; x <= len; x++ )
+   {
+      text = _mm256_loadu_si256( (const __m256i *) ( block + ( x - 1 ) * LANES ) );
+      lastdiag = column[0];
+      column[0] = _mm256_set1_epi8( (char) x );
+      for ( y = 1; y <= len; y++ )
+      {
+         olddiag = column[y];
+         cost = _mm256_andnot_si256( _mm256_cmpeq_epi8( text, _mm256_set1_epi8( word[y - 1] ) ), one );
+         column[y] = _mm256_min_epu8( _mm256_min_epu8( _mm256_add_epi8( column[y], one ),
+                                                       _mm256_add_epi8( column[y - 1], one ) ),
+                                      _mm256_add_epi8( lastdiag, cost ) );
+         lastdiag = olddiag;
+      }
+   }
+   _mm256_storeu_si256( (__m256i *) dist, column[len] );
+}
+
+__attribute__(( target( "sse4.2" ) ))
+static void levBlockSse ( const char *word, const int len, const unsigned char *block, unsigned char *dist )
+{
+   // function to fill dist with the distances of word to the LANES words of block, 16 lanes at a time
+
+   __m128i column[MAXL + 1];
+   __m128i lastdiag, olddiag, text, cost;
+   const __m128i one = _mm_set1_epi8( 1 );
+   int half, x, y;
+
+   column[0] = _mm_setzero_si128();                           // set again below; this lets the compiler see it is set
+   for ( half = 0; half < LANES; half += 16 )                 // two 16 lane halves make up one block
+   {
+      for ( y = 0; y <= len; y++ )
+         column[y] = _mm_set1_epi8( (char) y );
+      for ( x = 1; x <= len; x++ )
+      {
+         text = _mm_loadu_si128( (const __m128i *) ( block + ( x - 1 ) * LANES + half ) );
+         lastdiag = column[0];
+         column[0] = _mm_set1_epi8( (char) x );
+         for ( y = 1; y <= len; y++ )
+         {
+            olddiag = column[y];
+            cost = _mm_andnot_si128( _mm_cmpeq_epi8( text, _mm_set1_epi8( word[y - 1] ) ), one );
+            column[y] = _mm_min_epu8( _mm_min_epu8( _mm_add_epi8( column[y], one ), _mm_add_epi8( column[y - 1], one ) ),
+                                      _mm_add_epi8( lastdiag, cost ) );
+            lastdiag = olddiag;
+         }
+      }
+      _mm_storeu_si128( (__m128i *) ( dist + half ), column[len] );
+   }
+}
+#endif
+
+/***************************** function pickLevBlock ******************************/
+
+static levBlockFn pickLevBlock ( void )
+{
+   // function to return the best SIMD block kernel this processor can run, or NULL if there is none
+
+#ifdef HAVE_X86_SIMD
+   __builtin_cpu_init();
+   if ( __builtin_cpu_supports( "avx2" ) )
+      return levBlockAvx2;
+   if ( __builtin_cpu_supports( "sse4.2" ) )
+      return levBlockSse;
+#endif
+   return NULL;
+}
+
+/***************************** function transposeBuild ******************************/
+
+static int transposeBuild ( struct transposedBucket transposed[], const struct dictionary *dict,
+                            const long int *wordLenIndex )
+{
+   /* function to make for each word length 5..MAXL (the lengths returnWord searches) a copy of the words of that
+      length stored character position major in blocks of LANES words.  Only the leading words of the bucket that
+      really have that length are copied (the scan handles any others one by one).
+      Returns 0 on success, -1 if memory ran out. */
+
+   long int i, endIndex, numBlocks;
+   int len, pos;
+
+   memset( transposed, 0, ( MAXL + 1 ) * sizeof( *transposed ) );
+   for ( len = 5; len <= MAXL; len++ )
+   {
+      if ( wordLenIndex[len] == 0 )
+         continue;
+      endIndex = bucketEnd( wordLenIndex, len );
+      transposed[len].start = wordLenIndex[len];
+      for ( i = wordLenIndex[len]; i <= endIndex && dictLength( dict, i ) == len; i++ )
+         ;
+      transposed[len].count = i - wordLenIndex[len];
+      numBlocks = ( transposed[len].count + LANES - 1 ) / LANES;
+      if ( numBlocks == 0 )
+         continue;
+      if ( ( transposed[len].chars = calloc( (size_t) ( numBlocks * len * LANES ), 1 ) ) == NULL )
+         return -1;
+      for ( i = 0; i < transposed[len].count; i++ )
+         for ( pos = 0; pos < len; pos++ )
+            transposed[len].chars[( ( i / LANES ) * len + pos ) * LANES + i % LANES] =
+               (unsigned char) dictWord( dict, transposed[len].start + i )[pos];
+   }
+   return 0;
+}
+
+/***************************** function bkBuild ******************************/
+
+static void bkBuild ( struct bkNode bkTree[], const struct dictionary *dict, const long int *wordLenIndex,
+                      const struct searchIndex *index )
+{
+   /* function to build one BK-tree for each word length in the dictionary.  The root of the tree for words of length
+      len is word wordLenIndex[len] and the other words are inserted in dictionary order.  A child hangs
+      from its parent at the edit distance between the two, so by the triangle inequality a word at distance d
+      from the input word can only be below a child whose edge lies in [d(input, parent) - d, d(input, parent) + d]. */
+
+   struct levPattern pattern;
+   long int i, k, node, endIndex;
+   int len, d;
+
+   for ( i = 0; i < wordLenIndex[0]; i++ )
+   {
+      bkTree[i].child = bkTree[i].sibling = -1;
+      bkTree[i].dist = 0;
+   }
+   for ( len = 1; len <= MAXL; len++ )
+   {
+      if ( wordLenIndex[len] == 0 )
+         continue;
+      endIndex = bucketEnd( wordLenIndex, len );
+      for ( i = wordLenIndex[len] + 1; i <= endIndex; i++ )
+      {
+         node = wordLenIndex[len];
+         levPrepare( &pattern, dictWord( dict, i ) );
+         while ( 1 )
+         {
+            d = wordDistance( index, &pattern, dictWord( dict, node ), MAXL + 1 );
+            for ( k = bkTree[node].child; k != -1 && bkTree[k].dist != d; k = bkTree[k].sibling )
+               ;
+            if ( k == -1 )
+            {
+               bkTree[i].dist = d;
+               bkTree[i].sibling = bkTree[node].child;
+               bkTree[node].child = i;
+               break;
+            }
+            node = k;
+         }
+      }
+   }
+}
+
+/***************************** function bkSearch ******************************/
+
+static void bkSearch ( const struct searchIndex *index, const struct dictionary *dict, const long int node,
+                       const struct levPattern *pattern, int *lastSR, long int *bestIndex )
+{
+   /* function to walk the BK-tree below node looking for the dictionary word nearest to the pattern word.
+      On entry *lastSR is the largest distance still of interest (and *bestIndex the word that has it, -1 if none);
+      ties are kept for the lowest index so the result is the first best match in dictionary order just as
+      a linear scan of the bucket would find it. */
+
+   const struct bkNode *bkTree = index->bkTree;
+   long int k;
+   int d = wordDistance( index, pattern, dictWord( dict, node ), MAXL + 1 );
+
+   threadStats.comparisons++;
+   if ( d < *lastSR || ( d == *lastSR && ( *bestIndex == -1 || node < *bestIndex ) ) )
+   {
+      *lastSR = d;
+      *bestIndex = node;
+   }
+   for ( k = bkTree[node].child; k != -1; k = bkTree[k].sibling )
+      if ( d - *lastSR <= bkTree[k].dist && bkTree[k].dist <= d + *lastSR )
+         bkSearch( index, dict, k, pattern, lastSR, bestIndex );
+}
+
+/***************************** function hashMore ******************************/
+
+static unsigned long long hashMore ( unsigned long long h, const char *bytes, const size_t numBytes )
+{
+   // function to continue the 64 bit FNV-1a hash h over numBytes more bytes (start with h = 14695981039346656037)
+
+   size_t k;
+
+   for ( k = 0; k < numBytes; k++ )
+      h = ( h ^ (unsigned char) bytes[k] ) * 1099511628211ULL;
+   return h;
+}
+
+/***************************** function hashWord ******************************/
+
+static unsigned long long hashWord ( const char *word, const int wordLen )
+{
+   // function to return the 64 bit FNV-1a hash of the wordLen characters of word; never 0 (the empty slot mark)
+
+   unsigned long long h = hashMore( 14695981039346656037ULL, word, (size_t) wordLen );
+
+   return h ? h : 1;
+}
+
+/***************************** function forEachDeletion ******************************/
+
+static void forEachDeletion ( char *word, const int wordLen, const int from, const int edits,
+                              void (*fn)( unsigned long long key, void *arg ), void *arg )
+{
+   /* function to call fn with the hash of word and then of every variant of word made by deleting up to
+      edits characters at positions from and after (word itself is restored before returning).
+      The same variant may be reported more than once when word has runs of a repeated letter. */
+
+   char deleted;
+   int k;
+
+   if ( from == 0 )
+      fn( hashWord( word, wordLen ), arg );
+   if ( edits == 0 )
+      return;
+   for ( k = from; k < wordLen; k++ )
+   {
+      deleted = word[k];
+      memmove( word + k, word + k + 1, (size_t) ( wordLen - k ) );
+      fn( hashWord( word, wordLen - 1 ), arg );
+      forEachDeletion( word, wordLen - 1, k, edits - 1, fn, arg );
+      memmove( word + k + 1, word + k, (size_t) ( wordLen - k ) );
+      word[k] = deleted;
+   }
+}
+
+/***************************** function symTable ******************************/
+
+struct symPair
+{
+   unsigned long long key;
+   unsigned int word;
+};
+
+struct symPairs                  // used by symBuild and holeBuild to collect (key, word) pairs
+{
+   struct symPair *pair;
+   unsigned long int num;
+   unsigned long int max;
+   unsigned int word;            // the word whose deletions are being collected
+   _Bool failed;
+};
+
+static void symCollect ( unsigned long long key, void *arg )
+{
+   struct symPairs *p = arg;
+   struct symPair *grown;
+
+   if ( p->failed )
+      return;
+   if ( p->num == p->max )
+   {
+      p->max = p->max ? 2 * p->max : 1 << 20;
+      if ( ( grown = realloc( p->pair, p->max * sizeof( *grown ) ) ) == NULL )
+      {
+         p->failed = (_Bool) 1;
+         return;
+      }
+      p->pair = grown;
+   }
+   p->pair[p->num].key = key;
+   p->pair[p->num].word = p->word;
+   p->num++;
+}
+
+static int symPairCmp ( const void *a, const void *b )
+{
+   const struct symPair *x = a, *y = b;
+
+   if ( x->key != y->key )
+      return x->key < y->key ? -1 : 1;
+   return ( x->word > y->word ) - ( x->word < y->word );
+}
+
+static int symTable ( struct symIndex *sym, struct symPairs *pairs )
+{
+   /* function to turn the (key, word) pairs collected for an index into its hash table and postings (the words
+      of a key in ascending order).  pairs->pair is freed.  Returns 0 on success, -1 if memory ran out. */
+
+   unsigned long int i, j, n, slot, numKeys = 0;
+
+   if ( pairs->failed )
+   {
+      free( pairs->pair );
+      return -1;
+   }
+   qsort( pairs->pair, pairs->num, sizeof( *pairs->pair ), symPairCmp );
+
+   for ( i = n = 0; i < pairs->num; i++ )                    // drop repeated pairs and count the distinct keys
+      if ( n == 0 || symPairCmp( &pairs->pair[i], &pairs->pair[n - 1] ) != 0 )
+      {
+         if ( n == 0 || pairs->pair[i].key != pairs->pair[n - 1].key )
+            numKeys++;
+         pairs->pair[n++] = pairs->pair[i];
+      }
+   for ( sym->mask = 1; sym->mask < 2 * numKeys; sym->mask <<= 1 )
+      ;
+   sym->slots = calloc( sym->mask, sizeof( *sym->slots ) );
+   sym->posting = malloc( ( n ? n : 1 ) * sizeof( *sym->posting ) );
+   sym->mask--;
+   if ( sym->slots == NULL || sym->posting == NULL )
+   {
+      free( pairs->pair );
+      return -1;
+   }
+   for ( i = 0; i < n; i = j )
+   {
+      for ( j = i; j < n && pairs->pair[j].key == pairs->pair[i].key; j++ )
+         sym->posting[j] = pairs->pair[j].word;
+      for ( slot = pairs->pair[i].key & sym->mask; sym->slots[slot].key; slot = ( slot + 1 ) & sym->mask )
+         ;
+      sym->slots[slot].key = pairs->pair[i].key;
+      sym->slots[slot].first = (unsigned int) i;
+      sym->slots[slot].count = (unsigned int) ( j - i );
+   }
+   sym->numPostings = n;
+   free( pairs->pair );
+   return 0;
+}
+
+/***************************** function symBuild ******************************/
+
+static int symBuild ( struct symIndex *sym, const struct dictionary *dict, const long int *wordLenIndex )
+{
+   /* function to build the symmetric-delete index: every dictionary word that returnWord may be asked about
+      (5 to MAXL characters) is entered under its own hash and under the hash of each of its deletion variants
+      with up to maxEdits(length) characters removed.  Two words of the same length within edit distance d
+      share a variant made by at most d deletions from each, so probing the deletion variants of the input word
+      finds every candidate.  Returns 0 on success, -1 if memory ran out. */
+
+   struct symPairs pairs = { NULL, 0, 0, 0, (_Bool) 0 };
+   char word[MAXL + 1];
+   long int w, endIndex;
+   int len;
+
+   memset( sym, 0, sizeof( *sym ) );
+   for ( len = 5; len <= MAXL; len++ )
+   {
+      if ( wordLenIndex[len] == 0 )
+         continue;
+      endIndex = bucketEnd( wordLenIndex, len );
+      for ( w = wordLenIndex[len]; w <= endIndex; w++ )
+      {
+         strcpy( word, dictWord( dict, w ) );
+         pairs.word = (unsigned int) w;
+         forEachDeletion( word, (int) strlen( word ), 0, maxEdits( len ), symCollect, &pairs );
+      }
+   }
+   return symTable( sym, &pairs );
+}
+
+/***************************** function symSearch ******************************/
+
+struct symProbe                  // used by symSearch to gather the candidates found under the input word's deletions
+{
+   const struct symIndex *sym;
+   long int startIndex;
+   long int endIndex;
+   long int *cand;
+   unsigned long int num;
+   unsigned long int max;
+   _Bool failed;
+};
+
+static void symGather ( unsigned long long key, void *arg )
+{
+   struct symProbe *p = arg;
+   const struct symIndex *sym = p->sym;
+   unsigned long int slot, k;
+   long int *grown;
+
+   for ( slot = key & sym->mask; sym->slots[slot].key && sym->slots[slot].key != key; slot = ( slot + 1 ) & sym->mask )
+      ;
+   if ( sym->slots[slot].key == 0 )
+      return;
+   for ( k = sym->slots[slot].first; k < sym->slots[slot].first + sym->slots[slot].count; k++ )
+   {
+      if ( (long int) sym->posting[k] < p->startIndex || (long int) sym->posting[k] > p->endIndex )
+         continue;
+      if ( p->num == p->max )
+      {
+         p->max = 2 * p->max;
+         if ( ( grown = realloc( p->cand, p->max * sizeof( *grown ) ) ) == NULL )
+         {
+            p->failed = (_Bool) 1;
+            return;
+         }
+         p->cand = grown;
+      }
+      p->cand[p->num++] = (long int) sym->posting[k];
+   }
+}
+
+static int candCmp ( const void *a, const void *b )
+{
+   const long int *x = a, *y = b;
+   return ( *x > *y ) - ( *x < *y );
+}
+
+static long int symSearch ( const struct searchIndex *index, const struct dictionary *dict,
+                            const struct levPattern *pattern, const int maxED, const long int startIndex,
+                            const long int endIndex, int *lastSR )
+{
+   /* function to return the index of the first best match for the pattern word among the words startIndex..endIndex
+      (or -1 if none is within maxED) using the symmetric-delete index.  *lastSR receives the distance found.
+      Returns -2 if memory for the candidates ran out and the caller should scan instead. */
+
+   char word[MAXL + 1];
+   struct symProbe probe;
+   unsigned long int k;
+   long int bestIndex = -1;
+   int levResult;
+
+   probe.sym = &index->sym;
+   probe.startIndex = startIndex;
+   probe.endIndex = endIndex;
+   probe.num = 0;
+   probe.max = 64;
+   probe.failed = (_Bool) 0;
+   if ( ( probe.cand = malloc( probe.max * sizeof( *probe.cand ) ) ) == NULL )
+      return -2;
+   strcpy( word, pattern->word );
+   forEachDeletion( word, (int) strlen( word ), 0, maxED, symGather, &probe );
+   if ( probe.failed )
+   {
+      free( probe.cand );
+      return -2;
+   }
+   qsort( probe.cand, probe.num, sizeof( *probe.cand ), candCmp );
+   *lastSR = maxED + 1;
+   for ( k = 0; k < probe.num && *lastSR != 0; k++ )
+   {
+      if ( k > 0 && probe.cand[k] == probe.cand[k - 1] )
+         continue;
+      levResult = wordDistance( index, pattern, dictWord( dict, probe.cand[k] ), *lastSR );
+      threadStats.comparisons++;
+      if ( levResult < *lastSR )
+      {
+         bestIndex = probe.cand[k];
+         *lastSR = levResult;
+      }
+   }
+   free( probe.cand );
+   return bestIndex;
+}
+
+/***************************** function holeKey ******************************/
+
+/* The hole index serves the sim matcher.  simWords finds a test word of n characters similar to a dictionary word
+   when, for some j in 0..n-2, taking the pair of characters at j out of the test word leaves
+      HOLE_PAIR   the dictionary word (of n characters) with its pair at j taken out, or
+      HOLE_SPLIT  the dictionary word (of n - 1 characters) with its one character at j taken out (u -> tt).
+   Each dictionary word is entered under both kinds of signature for every j, so a lookup is 2 (n - 1) probes
+   for the signatures of the test word; the words found are then checked with simWords itself. */
+
+#define HOLE_PAIR 'p'
+#define HOLE_SPLIT 's'
+
+static unsigned long long holeKey ( const char kind, const int j, const char *word, const int wordLen,
+                                    const int holeLen )
+{
+   // function to return the hash of the signature (kind, j, word without its holeLen characters at j); never 0
+
+   const char tag[2] = { kind, (char) j };
+   unsigned long long h = hashMore( 14695981039346656037ULL, tag, 2 );
+
+   h = hashMore( h, word, (size_t) j );
+   h = hashMore( h, word + j + holeLen, (size_t) ( wordLen - j - holeLen ) );
+   return h ? h : 1;
+}
+
+/***************************** function holeBuild ******************************/
+
+static int holeBuild ( struct symIndex *hole, const struct dictionary *dict )
+{
+   /* function to build the hole index over every dictionary word: word w of len characters is entered under
+      (HOLE_PAIR, j) for j in 0..len-2 and (HOLE_SPLIT, j) for j in 0..len-1.
+      Returns 0 on success, -1 if memory ran out. */
+
+   struct symPairs pairs = { NULL, 0, 0, 0, (_Bool) 0 };
+   const char *word;
+   long int w;
+   int len, j;
+
+   memset( hole, 0, sizeof( *hole ) );
+   for ( w = 0; w < dict->numWords; w++ )
+   {
+      word = dictWord( dict, w );
+      len = dictLength( dict, w );
+      pairs.word = (unsigned int) w;
+      for ( j = 0; j < len; j++ )
+      {
+         if ( j + 1 < len )
+            symCollect( holeKey( HOLE_PAIR, j, word, len, 2 ), &pairs );
+         symCollect( holeKey( HOLE_SPLIT, j, word, len, 1 ), &pairs );
+      }
+   }
+   return symTable( hole, &pairs );
+}
+
+/***************************** function holeSearch ******************************/
+
+static long int holeSearch ( const struct searchIndex *index, const struct dictionary *dict, const char *word,
+                             const int wordLen, const long int startIndex, const long int endIndex, const int enough,
+                             int *lastSR )
+{
+   /* function to return what a scan of the words startIndex..endIndex with simWords would: the index of the first
+      word identical to word or else of the first word similar to it (-1 if none), with its simWords result in
+      *lastSR.  Only the words found under the signatures of word are looked at, and only until one scores
+      enough (see struct matchQuery).
+      Returns -2 if memory for the candidates ran out and the caller should scan instead. */
+
+   struct symProbe probe;
+   unsigned long int k, n;
+   long int bestIndex = -1;
+   int j, simResult;
+
+   probe.sym = &index->hole;
+   probe.startIndex = startIndex;
+   probe.endIndex = endIndex;
+   probe.num = 0;
+   probe.max = 64;
+   probe.failed = (_Bool) 0;
+   if ( ( probe.cand = malloc( probe.max * sizeof( *probe.cand ) ) ) == NULL )
+      return -2;
+   for ( j = 0; j + 1 < wordLen; j++ )
+   {
+      symGather( holeKey( HOLE_PAIR, j, word, wordLen, 2 ), &probe );
+      symGather( holeKey( HOLE_SPLIT, j, word, wordLen, 2 ), &probe );
+   }
+   if ( probe.failed )
+   {
+      free( probe.cand );
+      return -2;
+   }
+   qsort( probe.cand, probe.num, sizeof( *probe.cand ), candCmp );
+   for ( k = n = 0; k < probe.num; k++ )                     // the candidates once each, in dictionary order
+      if ( n == 0 || probe.cand[k] != probe.cand[n - 1] )
+         probe.cand[n++] = probe.cand[k];
+   *lastSR = 0;
+   for ( k = 0; k < n && *lastSR < enough; k++ )
+   {
+      simResult = simWords( word, dictWord( dict, probe.cand[k] ) );
+      threadStats.comparisons++;
+      if ( simResult > *lastSR )
+      {
+         bestIndex = probe.cand[k];
+         *lastSR = simResult;
+      }
+   }
+   free( probe.cand );
+   return bestIndex;
+}
+
+/***************************** the exact word table ******************************/
+
+/* Most words of an ocr text are spelled right, and a search only finds that out when it reaches the identical
+   dictionary word: the lev scan somewhere in the bucket, the sim scan only after the whole bucket of one character
+   less.  returnWord therefore first looks the word up in a hash table of every dictionary word (built when the
+   dictionary is read, or mapped from an image) and a word found there is left as it is without any search, which
+   is what every matcher would have made of it.  The table is open addressing over the narrow words, a slot holding
+   the index + 1 of the first dictionary word with its hash (0 for an empty slot), at most half full, so a lookup
+   is one hash and usually one string compare.
+
+   Knowing the word is not in the dictionary also ends a scan sooner: no word at edit distance 0 (or identical, for
+   sim) is left to find, so the first word at distance 1 (or similar) in dictionary order is already the answer. */
+
+/***************************** function exactBuild ******************************/
+
+static int exactBuild ( struct exactIndex *exact, const struct dictionary *dict )
+{
+   // function to put every dictionary word into exact (a repeated word keeps its first index); returns 0 or -1
+
+   unsigned long int slot;
+   long int i;
+
+   for ( exact->mask = 1; exact->mask < 2 * (unsigned long int) dict->numWords; exact->mask <<= 1 )
+      ;
+   exact->mask--;
+   if ( ( exact->slots = calloc( exact->mask + 1, sizeof( *exact->slots ) ) ) == NULL )
+      return -1;
+   for ( i = 0; i < dict->numWords; i++ )
+   {
+      slot = (unsigned long int) hashMore( 14695981039346656037ULL, dictWord( dict, i ), (size_t) dictLength( dict, i ) )
+             & exact->mask;
+      for ( ; exact->slots[slot] != 0; slot = ( slot + 1 ) & exact->mask )
+         if ( strcmp( dictWord( dict, exact->slots[slot] - 1 ), dictWord( dict, i ) ) == 0 )
+            break;
+      if ( exact->slots[slot] == 0 )
+         exact->slots[slot] = (unsigned int) i + 1;
+   }
+   return 0;
+}
+
+/***************************** function exactFind ******************************/
+
+static _Bool exactFind ( const struct exactIndex *exact, const struct dictionary *dict, const char *word,
+                         const int wordLen )
+{
+   // function to return true if the narrow word of wordLen characters is in the dictionary
+
+   unsigned long int slot = (unsigned long int) hashMore( 14695981039346656037ULL, word, (size_t) wordLen ) & exact->mask;
+
+   for ( ; exact->slots[slot] != 0; slot = ( slot + 1 ) & exact->mask )
+      if ( dictLength( dict, exact->slots[slot] - 1 ) == wordLen
+           && memcmp( dictWord( dict, exact->slots[slot] - 1 ), word, (size_t) wordLen ) == 0 )
+         return (_Bool) 1;
+   return (_Bool) 0;
+}
+
+/***************************** the ocr matcher ******************************/
+
+/* --matcher ocr replaces a word by the dictionary word of least weighted edit distance to it, if that is within the
+   budget for its length.  The costs come from a confusion table (--confusions file, else defaultConfusions): a
+   plain edit costs OCR_EDIT, but the mistakes ocr makes are cheaper, and a rule may read several characters as
+   others (rn for m, li for h, tt for u), so the word may be longer or shorter than the dictionary word.  Each line
+   of the file is one of
+
+      text dictionary cost      the text has text where the dictionary word has dictionary (up to OCR_RULE_MAX
+                                characters each, - for none); single characters set the substitution, insertion
+                                or deletion cost of that pair
+      edit cost                 the cost of any other edit (OCR_EDIT)
+      budget length cost        the most a correction of a word of length characters or more may cost
+
+   with # starting a comment.  The dictionary is kept as a trie (built when the dictionary is read, not stored in
+   an image) and searched depth first: the DP row of a node is made from its parent's, so words that share a prefix
+   share its rows, and a branch is left as soon as no row it could still build on is within the best cost found. */
+
+#define OCR_EDIT 100               // default cost of a plain edit
+#define OCR_RULE_MAX 3             // most characters on either side of a rule
+#define OCR_MAX_RULES 256
+
+struct ocrRule                     // a rule of more than one character on a side (or none on one)
+{
+   unsigned char text[OCR_RULE_MAX], dict[OCR_RULE_MAX];   // narrow, as the words they match
+   int textLen, dictLen;
+   int cost;
+   int next;                       // next rule ending with the same dictionary (or, with none, text) character
+};
+
+struct confusionTable
+{
+   unsigned short sub[256][256];   // sub[t][d]: the cost of reading dictionary character d as t (0 on the diagonal)
+   unsigned short ins[256];        // ins[d]: the cost of dictionary character d missing from the text
+   unsigned short del[256];        // del[t]: the cost of a stray t in the text
+   int budget[MAXL + 1];           // budget[n]: the most a correction of a word of n characters may cost
+   struct ocrRule rule[OCR_MAX_RULES];
+   int numRules;
+   int byDict[256];                // first rule whose dictionary side ends with the character (-1 for none)
+   int byText[256];                // first rule with no dictionary side whose text ends with the character
+   int reach;                      // the longest dictionary side of a rule: how many rows back a row may look
+};
+
+static const char *defaultConfusions[] =   // the splits bench/ocrNoise makes, and common single character misreads
+{
+   "rn m 30", "tt u 30", "li h 30", "cl d 30", "vv w 30", "in m 40", "ni m 40", "ii u 40", "iii m 50",
+   "c e 40", "e c 40", "l i 40", "i l 40", "1 l 40", "l 1 40", "0 o 40", "o 0 40", "n u 50", "u n 50",
+   "h b 50", "b h 50", "f t 50", "t f 50", "a o 60", "o a 60", "r n 60",
+   "budget 1 100", "budget 8 150", "budget 14 200", NULL
+};
+
+/***************************** function ocrTableLine ******************************/
+
+static int ocrNarrowSide ( const struct dictionary *dict, const char *side, unsigned char *narrow )
+{
+   // function to put the rule side (UTF-8, or - for none) in narrow form; returns its length, -1 if too long
+
+   char buf[MAXL + 1];
+   _Bool capitalized;
+   int n;
+
+   if ( strcmp( side, "-" ) == 0 )
+      return 0;
+   if ( ( n = narrowWord( dict, side, strlen( side ), buf, &capitalized ) ) < 0 || n > OCR_RULE_MAX )
+      return -1;
+   memcpy( narrow, buf, (size_t) n );
+   return n;
+}
+
+static int ocrTableLine ( struct confusionTable *table, const struct dictionary *dict, char *line )
+{
+   // function to add one line of a confusion table to table; returns 0, or -1 if the line makes no sense
+
+   char *field[3], *tok, *save = NULL;
+   unsigned char text[OCR_RULE_MAX], dictSide[OCR_RULE_MAX];
+   int numFields = 0, textLen, dictLen, cost, k;
+   struct ocrRule *r;
+
+   if ( strchr( line, '#' ) )
+      *strchr( line, '#' ) = '\0';
+   for ( tok = strtok_r( line, " \t\r\n", &save ); tok; tok = strtok_r( NULL, " \t\r\n", &save ) )
+   {
+      if ( numFields == 3 )
+         return -1;
+      field[numFields++] = tok;
+   }
+   if ( numFields == 0 )
+      return 0;
+   if ( numFields == 2 && strcmp( field[0], "edit" ) == 0 && ( cost = atoi( field[1] ) ) > 0 )
+   {
+      for ( k = 0; k < 256 * 256; k++ )
+         if ( k / 256 != k % 256 )
+            table->sub[k / 256][k % 256] = (unsigned short) cost;
+      for ( k = 0; k < 256; k++ )
+         table->ins[k] = table->del[k] = (unsigned short) cost;
+      return 0;
+   }
+   if ( numFields != 3 || ( cost = atoi( field[2] ) ) <= 0 || cost > 10000 )
+      return -1;
+   if ( strcmp( field[0], "budget" ) == 0 )
+   {
+      if ( ( k = atoi( field[1] ) ) < 1 || k > MAXL )
+         return -1;
+      for ( ; k <= MAXL; k++ )
+         table->budget[k] = cost;
+      return 0;
+   }
+   if ( ( textLen = ocrNarrowSide( dict, field[0], text ) ) < 0 || ( dictLen = ocrNarrowSide( dict, field[1], dictSide ) ) < 0
+        || textLen + dictLen == 0 )
+      return -1;
+   if ( textLen == 1 && dictLen == 1 )
+      table->sub[text[0]][dictSide[0]] = (unsigned short) cost;
+   else if ( textLen == 0 && dictLen == 1 )
+      table->ins[dictSide[0]] = (unsigned short) cost;
+   else if ( textLen == 1 && dictLen == 0 )
+      table->del[text[0]] = (unsigned short) cost;
+   else
+   {
+      if ( table->numRules == OCR_MAX_RULES )
+         return -1;
+      r = &table->rule[table->numRules];
+      memcpy( r->text, text, (size_t) textLen );
+      memcpy( r->dict, dictSide, (size_t) dictLen );
+      r->textLen = textLen;
+      r->dictLen = dictLen;
+      r->cost = cost;
+      if ( dictLen > 0 )
+      {
+         r->next = table->byDict[dictSide[dictLen - 1]];
+         table->byDict[dictSide[dictLen - 1]] = table->numRules++;
+      }
+      else
+      {
+         r->next = table->byText[text[textLen - 1]];
+         table->byText[text[textLen - 1]] = table->numRules++;
+      }
+      if ( dictLen > table->reach )
+         table->reach = dictLen;
+   }
+   return 0;
+}
+
+/***************************** function ocrTableLoad ******************************/
+
+static int ocrTableLoad ( struct confusionTable *table, const struct dictionary *dict, const char *path )
+{
+   /* function to fill in table from the confusion table file path, or defaultConfusions if path is NULL, over the
+      defaults (every edit OCR_EDIT, a budget of OCR_EDIT).  It must be called once the dictionary is read, as the
+      rules are put in its narrow form.  Returns 0, or -1 if the file cannot be read or has a bad line. */
+
+   char line[256];
+   FILE *f = NULL;
+   int k, lineNum = 0;
+
+   memset( table, 0, sizeof( *table ) );
+   for ( k = 0; k < 256 * 256; k++ )
+      table->sub[k / 256][k % 256] = k / 256 == k % 256 ? 0 : OCR_EDIT;
+   for ( k = 0; k < 256; k++ )
+   {
+      table->ins[k] = table->del[k] = OCR_EDIT;
+      table->byDict[k] = table->byText[k] = -1;
+   }
+   for ( k = 0; k <= MAXL; k++ )
+      table->budget[k] = OCR_EDIT;
+   table->reach = 1;
+   if ( path && ( f = fopen( path, "r" ) ) == NULL )
+   {
+      fprintf (stderr, "cannot read the confusion table %s\n", path);
+      return -1;
+   }
+   while ( f ? fgets( line, sizeof( line ), f ) != NULL : defaultConfusions[lineNum] != NULL )
+   {
+      if ( !f )
+         snprintf( line, sizeof( line ), "%s", defaultConfusions[lineNum] );
+      lineNum++;
+      if ( ocrTableLine( table, dict, line ) != 0 )
+      {
+         fprintf (stderr, "the confusion table %s has a bad line %d\n", path ? path : "(built in)", lineNum);
+         if ( f )
+            fclose( f );
+         return -1;
+      }
+   }
+   if ( f )
+      fclose( f );
+   return 0;
+}
+
+/***************************** function trieBuild ******************************/
+
+static long int trieBuild ( struct trieNode **trie, const struct dictionary *dict )
+{
+   /* function to build the trie of all the dictionary words: node 0 is the root and each other node one character
+      below its parent, its children linked through sibling in the order first met.  A node's word is the first
+      dictionary word (the most frequent) that ends there.  Returns the number of nodes, or -1 if memory ran out. */
+
+   long int i, node, k, numNodes = 1;
+   long int maxNodes = (long int) dict->offset[dict->numWords] + 1;   // at most one node per character
+   const unsigned char *w;
+
+   if ( ( *trie = malloc( (size_t) maxNodes * sizeof( **trie ) ) ) == NULL )
+      return -1;
+   ( *trie )[0].child = ( *trie )[0].sibling = ( *trie )[0].word = -1;
+   ( *trie )[0].c = 0;
+   for ( i = 0; i < dict->numWords; i++ )
+   {
+      node = 0;
+      for ( w = (const unsigned char *) dictWord( dict, i ); *w; w++ )
+      {
+         for ( k = ( *trie )[node].child; k != -1 && ( *trie )[k].c != *w; k = ( *trie )[k].sibling )
+            ;
+         if ( k == -1 )
+         {
+            k = numNodes++;
+            ( *trie )[k].c = *w;
+            ( *trie )[k].child = -1;
+            ( *trie )[k].word = -1;
+            ( *trie )[k].sibling = ( *trie )[node].child;
+            ( *trie )[node].child = k;
+         }
+         node = k;
+      }
+      if ( ( *trie )[node].word == -1 )
+         ( *trie )[node].word = i;
+   }
+   return numNodes;
+}
+
+/***************************** function trieSearch ******************************/
+
+struct ocrQuery                    // the search of one word through the trie
+{
+   const struct dictionary *dict;
+   const struct trieNode *trie;
+   const struct confusionTable *table;
+   const unsigned char *t;         // the narrow text word
+   int n;                          // its characters
+   unsigned char path[MAXL + 1];   // the dictionary characters from the root to the node
+   int row[MAXL + 1][MAXL + 1];    // row[j][i]: the cost of reading path[0..j) as t[0..i)
+   int rowMin[MAXL + 1];
+   int best;                       // the least cost found (at first the budget)
+   long int bestIndex;             // the dictionary word that has it, -1 if none yet
+};
+
+static void ocrRow ( struct ocrQuery *q, const int j )
+{
+   // function to make row j of q from the rows above it, path[j - 1] being the new dictionary character
+
+   const struct confusionTable *table = q->table;
+   const unsigned char c = q->path[j - 1];
+   const int *up = q->row[j - 1];
+   int *row = q->row[j];
+   const struct ocrRule *r;
+   int i, k, v, m;
+
+   for ( i = 0; i <= q->n; i++ )
+   {
+      v = up[i] + table->ins[c];
+      if ( i > 0 )
+      {
+         v = MIN3( v, up[i - 1] + table->sub[q->t[i - 1]][c], row[i - 1] + table->del[q->t[i - 1]] );
+         for ( k = table->byText[q->t[i - 1]]; k != -1; k = r->next )   // text read with nothing in the dictionary
+         {
+            r = &table->rule[k];
+            if ( r->textLen <= i && memcmp( r->text, q->t + i - r->textLen, (size_t) r->textLen ) == 0
+                 && row[i - r->textLen] + r->cost < v )
+               v = row[i - r->textLen] + r->cost;
+         }
+      }
+      for ( k = table->byDict[c]; k != -1; k = r->next )
+      {
+         r = &table->rule[k];
+         if ( r->dictLen <= j && r->textLen <= i && memcmp( r->dict, q->path + j - r->dictLen, (size_t) r->dictLen ) == 0
+              && memcmp( r->text, q->t + i - r->textLen, (size_t) r->textLen ) == 0
+              && q->row[j - r->dictLen][i - r->textLen] + r->cost < v )
+            v = q->row[j - r->dictLen][i - r->textLen] + r->cost;
+      }
+      row[i] = v;
+   }
+   for ( m = row[0], i = 1; i <= q->n; i++ )
+      if ( row[i] < m )
+         m = row[i];
+   q->rowMin[j] = m;
+}
+
+static void trieSearch ( struct ocrQuery *q, const long int node, const int depth )
+{
+   /* function to search the trie below node (depth characters from the root, whose row is made) for the
+      dictionary word of least cost, ties going to the more frequent word (see rankedBefore) */
+
+   const struct trieNode *trie = q->trie;
+   long int k;
+   int j = depth + 1, back, m;
+
+   for ( k = trie[node].child; k != -1 && q->best > 0; k = trie[k].sibling )
+   {
+      if ( j > MAXL )
+         return;
+      q->path[depth] = trie[k].c;
+      ocrRow( q, j );
+      threadStats.comparisons++;
+      if ( trie[k].word >= 0 && ( q->row[j][q->n] < q->best || ( q->row[j][q->n] == q->best
+                                  && ( q->bestIndex == -1 || rankedBefore( q->dict, trie[k].word, q->bestIndex ) ) ) ) )
+      {
+         q->best = q->row[j][q->n];
+         q->bestIndex = trie[k].word;
+      }
+      for ( m = q->rowMin[j], back = 1; back < q->table->reach && back <= j; back++ )
+         if ( q->rowMin[j - back] < m )
+            m = q->rowMin[j - back];
+      if ( m <= q->best )                                   // a word below could still be as cheap
+         trieSearch( q, k, j );
+   }
+}
+
+/***************************** function searchOcr ******************************/
+
+static _Bool searchOcr ( char *outputWord, const char *givenWord, const int wordLen, const struct dictionary *dict,
+                         const struct searchIndex *index )
+{
+   /* function for the ocr matcher: copy to outputWord the dictionary word of least weighted edit distance to
+      givenWord, if that is within the budget for wordLen.  Returns true if outputWord was corrected to another word. */
+
+   struct ocrQuery q;
+   const struct confusionTable *table = index->confusions;
+   const struct ocrRule *r;
+   int i, k;
+
+   q.dict = dict;
+   q.trie = index->trie;
+   q.table = table;
+   q.t = (const unsigned char *) givenWord;
+   q.n = wordLen;
+   q.best = table->budget[wordLen];
+   q.bestIndex = -1;
+   q.row[0][0] = 0;                                          // row 0: the text read with no dictionary characters
+   for ( i = 1; i <= wordLen; i++ )
+   {
+      q.row[0][i] = q.row[0][i - 1] + table->del[q.t[i - 1]];
+      for ( k = table->byText[q.t[i - 1]]; k != -1; k = r->next )
+      {
+         r = &table->rule[k];
+         if ( r->textLen <= i && memcmp( r->text, q.t + i - r->textLen, (size_t) r->textLen ) == 0
+              && q.row[0][i - r->textLen] + r->cost < q.row[0][i] )
+            q.row[0][i] = q.row[0][i - r->textLen] + r->cost;
+      }
+   }
+   q.rowMin[0] = 0;
+   trieSearch( &q, 0, 0 );
+   if ( q.bestIndex >= 0 )
+      strcpy( outputWord, dictWord( dict, q.bestIndex ) );
+   threadStats.searches++;
+   k = ( q.best + OCR_EDIT - 1 ) / OCR_EDIT;                 // the cost in plain edits, rounded up
+   threadStats.found[q.bestIndex < 0 ? MAXL + 1 : k < maxEdits( MAXL ) ? k : maxEdits( MAXL )]++;
+   return (_Bool) ( q.bestIndex >= 0 && q.best > 0 && strcmp( outputWord, givenWord ) != 0 );
+}
+
+/***************************** the DAWG index ******************************/
+
+/* -i dawg keeps the dictionary for the lev matcher as a minimized DAWG (directed acyclic word graph): the trie of
+   the words (see trieBuild) with every set of identical subtrees stored once, so the Latin endings shared by
+   thousands of words (-ibus, -orum, -abantur) are stored a few times instead of once per word.  The graph is kept
+   in first child / next sibling form, a node standing for its character, its subtree and the rest of its
+   parent's list of children; two nodes are the same when all of those are.
+
+   A lookup walks the graph depth first carrying the Levenshtein DP row of the path so far against the input word,
+   which is the Levenshtein automaton of the word run over the graph: a branch is left as soon as every entry of
+   its row exceeds the best distance found (at first maxED) or no word of the input word's length ends below it,
+   so the work grows with the number of near words rather than with the size of a length bucket.  Words that
+   share a prefix share its rows.
+
+   A DAWG has no place to keep a word's dictionary index, so the words are numbered by counting: each node holds
+   the number of words ending at it, below it and further along its list, and a walk adds up the counts of the
+   nodes it passes over to get the number of the word it reaches.  dawgWord[number] is then the dictionary index
+   of the word (the first one, if the list has it twice), which gives a match its frequency rank as with the other
+   indexes. */
+
+struct dawgBuild                   // what dawgBuild needs while it merges the trie's nodes
+{
+   const struct trieNode *trie;
+   struct dawgNode *node;          // the DAWG so far
+   unsigned long int numNodes;     // including node 0
+   unsigned int *slots;            // hash table of the nodes, to find an identical one (0 for an empty slot)
+   unsigned long int mask;
+};
+
+/***************************** function dawgBuild ******************************/
+
+static unsigned int dawgIntern ( struct dawgBuild *b, const unsigned char c, const unsigned char final,
+                                 const unsigned int child, const unsigned int sibling )
+{
+   // function to return the DAWG node with c, final, child and sibling, adding it if there is not one yet
+
+   unsigned long long h = ( ( (unsigned long long) child * 0x9E3779B97F4A7C15ULL ) ^ ( (unsigned long long) sibling << 17 )
+                            ^ ( (unsigned long long) c << 8 ) ^ final ) * 0xC2B2AE3D27D4EB4FULL;
+   unsigned long int slot = (unsigned long int) ( h >> 20 ) & b->mask;
+   struct dawgNode *n;
+
+   for ( ; b->slots[slot] != 0; slot = ( slot + 1 ) & b->mask )
+   {
+      n = &b->node[b->slots[slot]];
+      if ( n->c == c && n->final == final && n->child == child && n->sibling == sibling )
+         return b->slots[slot];
+   }
+   n = &b->node[b->numNodes];
+   n->c = c;
+   n->final = final;
+   n->child = child;
+   n->sibling = sibling;
+   n->words = final + ( child ? b->node[child].words : 0 ) + ( sibling ? b->node[sibling].words : 0 );
+   n->lengths = final | ( child ? b->node[child].lengths << 1 : 0 ) | ( sibling ? b->node[sibling].lengths : 0 );
+   b->slots[slot] = (unsigned int) b->numNodes;
+   return (unsigned int) b->numNodes++;
+}
+
+static unsigned int dawgReduce ( struct dawgBuild *b, const long int first )
+{
+   // function to return the DAWG node of the trie's list of nodes starting at first (0 if first is -1)
+
+   long int list[256];             // the list, at most one node per narrow character
+   int k, numList = 0;
+   unsigned int sibling = 0;
+   long int t;
+
+   for ( t = first; t != -1; t = b->trie[t].sibling )
+      list[numList++] = t;
+   for ( k = numList - 1; k >= 0; k-- )                      // from the end of the list, as a node needs its sibling
+      sibling = dawgIntern( b, b->trie[list[k]].c, (unsigned char) ( b->trie[list[k]].word >= 0 ),
+                            dawgReduce( b, b->trie[list[k]].child ), sibling );
+   return sibling;
+}
+
+static int dawgBuild ( struct searchIndex *index, const struct dictionary *dict )
+{
+   /* function to build the DAWG of the dictionary words and its dawgWord numbering into index.  Returns 0, or -1
+      if memory ran out. */
+
+   struct dawgBuild b;
+   struct trieNode *trie;
+   long int numTrie, i;
+   unsigned long int k;
+   unsigned int n, number;
+   const unsigned char *w;
+
+   if ( ( numTrie = trieBuild( &trie, dict ) ) < 0 )
+      return -1;
+   memset( &b, 0, sizeof( b ) );
+   b.trie = trie;
+   for ( b.mask = 1; b.mask < 2 * (unsigned long int) numTrie; b.mask <<= 1 )
+      ;
+   b.mask--;
+   b.numNodes = 1;
+   b.node = calloc( (size_t) numTrie + 1, sizeof( *b.node ) );
+   b.slots = calloc( b.mask + 1, sizeof( *b.slots ) );
+   if ( b.node == NULL || b.slots == NULL )
+   {
+      free( trie );
+      free( b.node );
+      free( b.slots );
+      return -1;
+   }
+   index->dawgRoot = dawgReduce( &b, trie[0].child );
+   free( trie );
+   free( b.slots );
+   index->dawg = realloc( b.node, b.numNodes * sizeof( *b.node ) );
+   if ( index->dawg == NULL )
+      index->dawg = b.node;
+   index->dawgNodes = b.numNodes;
+   index->dawgWords = index->dawgRoot ? index->dawg[index->dawgRoot].words : 0;
+   if ( ( index->dawgWord = malloc( ( index->dawgWords + 1 ) * sizeof( *index->dawgWord ) ) ) == NULL )
+      return -1;
+   for ( k = 0; k < index->dawgWords; k++ )
+      index->dawgWord[k] = (unsigned int) -1;
+   for ( i = 0; i < dict->numWords; i++ )                    // number each word by walking to it
+   {
+      number = 0;
+      if ( *dictWord( dict, i ) == '\0' )
+         continue;
+      for ( n = index->dawgRoot, w = (const unsigned char *) dictWord( dict, i ); ; )
+      {
+         for ( ; index->dawg[n].c != *w; n = index->dawg[n].sibling )
+            number += index->dawg[n].words - ( index->dawg[n].sibling ? index->dawg[index->dawg[n].sibling].words : 0 );
+         if ( *++w == '\0' )
+            break;
+         number += index->dawg[n].final;
+         n = index->dawg[n].child;
+      }
+      if ( index->dawgWord[number] == (unsigned int) -1 )
+         index->dawgWord[number] = (unsigned int) i;
+   }
+   return 0;
+}
+
+/***************************** function dawgSearch ******************************/
+
+struct dawgQuery                   // the search of one word through the DAWG
+{
+   const struct dawgNode *dawg;
+   const unsigned int *dawgWord;
+   const unsigned char *t;         // the narrow input word
+   int n;                          // its characters
+   int row[MAXL + 1][MAXL + 1];    // row[j][i]: the edit distance between the path's first j characters and t[0..i)
+   int best;                       // the least distance found (at first maxED)
+   long int bestIndex;             // the dictionary word at that distance, -1 if none yet
+};
+
+static void dawgWalk ( struct dawgQuery *q, unsigned int node, const int depth, unsigned int number )
+{
+   /* function to search the list of nodes starting at node, depth characters below the root (whose row is made)
+      and whose first word has the number number, for the nearest word of q->n characters */
+
+   const struct dawgNode *dawg = q->dawg;
+   const int *up = q->row[depth];
+   int *row = q->row[depth + 1];
+   const int need = q->n - depth - 1;                        // characters still to come below node
+   unsigned int own;                                         // the node's word and the words below it
+   int i, m;
+   long int word;
+
+   for ( ; node != 0 && q->best > 0; number += own, node = dawg[node].sibling )
+   {
+      own = dawg[node].words - ( dawg[node].sibling ? dawg[dawg[node].sibling].words : 0 );
+      if ( ( ( dawg[node].final | ( dawg[node].child ? dawg[dawg[node].child].lengths << 1 : 0 ) ) >> need & 1 ) == 0 )
+         continue;                                           // no word of the right length ends below
+      row[0] = up[0] + 1;
+      for ( m = row[0], i = 1; i <= q->n; i++ )
+      {
+         row[i] = MIN3( up[i] + 1, row[i - 1] + 1, up[i - 1] + ( q->t[i - 1] == dawg[node].c ? 0 : 1 ) );
+         if ( row[i] < m )
+            m = row[i];
+      }
+      threadStats.comparisons++;
+      if ( need == 0 )
+      {
+         word = q->dawgWord[number];
+         if ( row[q->n] < q->best || ( row[q->n] == q->best && ( q->bestIndex == -1 || word < q->bestIndex ) ) )
+         {
+            q->best = row[q->n];
+            q->bestIndex = word;
+         }
+      }
+      else if ( m <= q->best )
+         dawgWalk( q, dawg[node].child, depth + 1, number + dawg[node].final );
+   }
+}
+
+static long int dawgSearch ( const struct searchIndex *index, const char *word, const int wordLen, int *lastSR )
+{
+   /* function to find through the DAWG the first dictionary word of wordLen characters nearest to word within
+      *lastSR edits (maxED).  Returns its index and sets *lastSR to its distance, or returns -1 if there is none. */
+
+   struct dawgQuery q;
+   int i;
+
+   q.dawg = index->dawg;
+   q.dawgWord = index->dawgWord;
+   q.t = (const unsigned char *) word;
+   q.n = wordLen;
+   q.best = *lastSR;
+   q.bestIndex = -1;
+   for ( i = 0; i <= wordLen; i++ )
+      q.row[0][i] = i;
+   if ( index->dawgRoot != 0 )
+      dawgWalk( &q, index->dawgRoot, 0, 0 );
+   if ( q.bestIndex >= 0 )
+      *lastSR = q.best;
+   return q.bestIndex;
+}
+
+/***************************** the correction cache ******************************/
+
+/* The correction cache (option -c file) remembers what returnWord made of each input word so later runs over
+   similar material skip the search.  The file is mmap-ed read only and used in place; the words first met in this
+   run go to a table in memory and the two are merged into a new file (written beside the old one and renamed over
+   it) when the program ends.  A cache made with another dictionary or other matching settings is not used: its
+   fingerprint (hash of the program's settings and of every dictionary word) would not match.
+
+   file layout (native byte order):  struct cacheHeader, then slotCount struct cacheSlot, then poolSize bytes of
+   entries.  An entry is a flags byte (CACHE_CORRECTED if the word counted as a correction) then the input word and
+   the returned word, each null-terminated.  Slots are an open addressing table over the hash of the input word. */
+
+#define CACHE_MAGIC "ASPCACHE"
+#define CACHE_VERSION 1
+#define CACHE_CORRECTED 1
+
+struct cacheHeader
+{
+   char magic[8];
+   unsigned int version;
+   unsigned int slotCount;        // a power of two
+   unsigned long long fingerprint;
+   unsigned long long numEntries;
+   unsigned long long poolSize;
+};
+
+struct cacheSlot
+{
+   unsigned int hash;             // low 32 bits of the hash of the input word
+   unsigned int offset;           // offset of the entry in the pool (0 marks an empty slot; the pool starts with a pad byte)
+};
+
+struct cacheTable                 // one open addressing table and its pool of entries
+{
+   struct cacheSlot *slots;
+   unsigned long int mask;        // slotCount - 1
+   unsigned long int numEntries;
+   char *pool;
+   size_t poolSize;
+   size_t poolMax;                // 0 for the mapped file, which is never added to
+};
+
+struct correctionCache
+{
+   const char *path;
+   unsigned long long fingerprint;
+   void *map;                     // the mapped file (NULL if there was no usable one)
+   size_t mapSize;
+   struct cacheTable old;         // entries from the file
+   struct cacheTable new;         // entries found in this run
+   pthread_mutex_t lock;          // guards new, which worker threads (option -j) add to
+};
+
+static const char *cacheFind ( const struct cacheTable *table, const char *word, const unsigned int hash )
+{
+   // function to return the entry of table for word or NULL
+
+   unsigned long int slot;
+
+   if ( table->slots == NULL )
+      return NULL;
+   for ( slot = hash & table->mask; table->slots[slot].offset; slot = ( slot + 1 ) & table->mask )
+      if ( table->slots[slot].hash == hash && strcmp( table->pool + table->slots[slot].offset + 1, word ) == 0 )
+         return table->pool + table->slots[slot].offset;
+   return NULL;
+}
+
+static int cacheInsert ( struct cacheTable *table, const unsigned int hash, const char *entry, const size_t entryLen )
+{
+   /* function to copy the entry (flags byte and the two words) into table, which must not be the mapped file,
+      growing its slots and pool as needed.  Returns 0 on success, -1 if memory ran out. */
+
+   struct cacheSlot *slots;
+   unsigned long int slot, k, numSlots;
+   char *pool;
+
+   if ( 2 * ( table->numEntries + 1 ) > ( table->slots ? table->mask + 1 : 0 ) )
+   {
+      numSlots = table->slots ? 2 * ( table->mask + 1 ) : 1024;
+      if ( ( slots = calloc( numSlots, sizeof( *slots ) ) ) == NULL )
+         return -1;
+      for ( k = 0; table->slots && k <= table->mask; k++ )
+         if ( table->slots[k].offset )
+         {
+            for ( slot = table->slots[k].hash & ( numSlots - 1 ); slots[slot].offset; slot = ( slot + 1 ) & ( numSlots - 1 ) )
+               ;
+            slots[slot] = table->slots[k];
+         }
+      free( table->slots );
+      table->slots = slots;
+      table->mask = numSlots - 1;
+   }
+   if ( table->poolSize + entryLen > table->poolMax )
+   {
+      table->poolMax = 2 * ( table->poolMax + entryLen ) + 4096;
+      if ( ( pool = realloc( table->pool, table->poolMax ) ) == NULL )
+         return -1;
+      table->pool = pool;
+      if ( table->poolSize == 0 )
+         table->pool[table->poolSize++] = '\0';          // the pad byte: offset 0 marks an empty slot
+   }
+   for ( slot = hash & table->mask; table->slots[slot].offset; slot = ( slot + 1 ) & table->mask )
+      ;
+   table->slots[slot].hash = hash;
+   table->slots[slot].offset = (unsigned int) table->poolSize;
+   memcpy( table->pool + table->poolSize, entry, entryLen );
+   table->poolSize += entryLen;
+   table->numEntries++;
+   return 0;
+}
+
+/***************************** function cacheIntact ******************************/
+
+static _Bool cacheIntact ( const struct cacheTable *table, const unsigned long long numEntries )
+{
+   /* function to check that every occupied slot of the mapped table points into the pool at an entry whose two
+      words end inside the pool and are each at most MAXL bytes (what returnWord's buffers hold), and that
+      numEntries slots are occupied, so cacheFind and cacheLookup stay within the map and their buffers */
+
+   unsigned long int slot, occupied = 0;
+   size_t offset, k, wordLen;
+
+   for ( slot = 0; slot <= table->mask; slot++ )
+   {
+      if ( ( offset = table->slots[slot].offset ) == 0 )
+         continue;
+      if ( offset >= table->poolSize )
+         return (_Bool) 0;
+      offset++;                                              // past the flags byte
+      for ( k = 0; k < 2; k++ )                              // the input word, then the returned word
+      {
+         for ( wordLen = 0; offset + wordLen < table->poolSize && table->pool[offset + wordLen]; wordLen++ )
+            if ( wordLen == MAXL )
+               return (_Bool) 0;
+         if ( offset + wordLen >= table->poolSize )
+            return (_Bool) 0;
+         offset += wordLen + 1;
+      }
+      occupied++;
+   }
+   return (_Bool) ( occupied == numEntries );
+}
+
+/***************************** function cacheOpen ******************************/
+
+static void cacheOpen ( struct correctionCache *cache, const char *path, const unsigned long long fingerprint )
+{
+   /* function to map the cache file at path if it exists, is intact and was made with the same fingerprint.
+      Otherwise the cache starts empty and the file is replaced when the cache is saved. */
+
+   const struct cacheHeader *header;
+   struct stat st;
+   int fd;
+
+   memset( cache, 0, sizeof( *cache ) );
+   cache->path = path;
+   cache->fingerprint = fingerprint;
+   pthread_mutex_init( &cache->lock, NULL );
+   if ( ( fd = open( path, O_RDONLY ) ) == -1 )
+      return;
+   if ( fstat( fd, &st ) == 0 && (size_t) st.st_size >= sizeof( *header ) )
+   {
+      cache->map = mmap( NULL, (size_t) st.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+      if ( cache->map == MAP_FAILED )
+         cache->map = NULL;
+      else
+         cache->mapSize = (size_t) st.st_size;
+   }
+   close( fd );
+   if ( cache->map == NULL )
+      return;
+   header = cache->map;
+   if ( memcmp( header->magic, CACHE_MAGIC, 8 ) != 0 || header->version != CACHE_VERSION
+        || header->slotCount == 0 || ( header->slotCount & ( header->slotCount - 1 ) ) != 0
+        || header->poolSize >= cache->mapSize
+        || sizeof( *header ) + header->slotCount * sizeof( struct cacheSlot ) + header->poolSize != cache->mapSize
+        || 2 * header->numEntries > header->slotCount || header->poolSize == 0
+        || ( (const char *) cache->map )[cache->mapSize - 1] != '\0' || header->fingerprint != fingerprint )
+   {
+      if ( header->fingerprint != fingerprint )
+         fprintf (stderr, "cache %s was made with another dictionary or other settings and is started afresh\n", path);
+      else
+         fprintf (stderr, "cache %s is damaged and is started afresh\n", path);
+      munmap( cache->map, cache->mapSize );
+      cache->map = NULL;
+      return;
+   }
+   cache->old.slots = (struct cacheSlot *) ( header + 1 );
+   cache->old.mask = header->slotCount - 1;
+   cache->old.numEntries = (unsigned long int) header->numEntries;
+   cache->old.pool = (char *) ( cache->old.slots + header->slotCount );
+   cache->old.poolSize = (size_t) header->poolSize;
+   if ( !cacheIntact( &cache->old, header->numEntries ) )
+   {
+      fprintf (stderr, "cache %s is damaged and is started afresh\n", path);
+      munmap( cache->map, cache->mapSize );
+      memset( &cache->old, 0, sizeof( cache->old ) );
+      cache->map = NULL;
+   }
+}
+
+/***************************** function cacheLookup ******************************/
+
+static _Bool cacheLookup ( struct correctionCache *cache, const char *word, char *outputWord, _Bool *corrected )
+{
+   // function to copy into outputWord what returnWord made of word in this or an earlier run; false if not known
+
+   unsigned int hash = (unsigned int) hashMore( 14695981039346656037ULL, word, strlen( word ) );
+   const char *entry = cacheFind( &cache->old, word, hash );
+
+   if ( entry == NULL )
+   {
+      pthread_mutex_lock( &cache->lock );
+      if ( ( entry = cacheFind( &cache->new, word, hash ) ) != NULL )
+      {
+         *corrected = (_Bool) ( entry[0] & CACHE_CORRECTED );
+         strcpy( outputWord, entry + 1 + strlen( entry + 1 ) + 1 );
+      }
+      pthread_mutex_unlock( &cache->lock );
+      return (_Bool) ( entry != NULL );
+   }
+   *corrected = (_Bool) ( entry[0] & CACHE_CORRECTED );
+   strcpy( outputWord, entry + 1 + strlen( entry + 1 ) + 1 );
+   return (_Bool) 1;
+}
+
+/***************************** function cacheAdd ******************************/
+
+static void cacheAdd ( struct correctionCache *cache, const char *word, const char *outputWord, const _Bool corrected )
+{
+   // function to remember that returnWord made outputWord of word (silently forgotten if memory runs out)
+
+   char entry[2 * MAXL + 3];
+   size_t wordLen = strlen( word );
+   size_t outputLen = strlen( outputWord );
+
+   entry[0] = corrected ? CACHE_CORRECTED : 0;
+   memcpy( entry + 1, word, wordLen + 1 );
+   memcpy( entry + 2 + wordLen, outputWord, outputLen + 1 );
+   pthread_mutex_lock( &cache->lock );
+   (void) cacheInsert( &cache->new, (unsigned int) hashMore( 14695981039346656037ULL, word, wordLen ),
+                       entry, wordLen + outputLen + 3 );
+   pthread_mutex_unlock( &cache->lock );
+}
+
+/***************************** function cacheSave ******************************/
+
+static int cacheSave ( struct correctionCache *cache )
+{
+   /* function to write the entries of the mapped file and of this run to a new cache file and rename it over
+      the old one.  Nothing is written if this run added nothing.  Returns 0 on success, -1 on failure. */
+
+   struct cacheHeader header;
+   struct cacheTable merged;
+   const struct cacheTable *from[2];
+   char *tmpPath;
+   const char *entry;
+   size_t entryLen;
+   unsigned long int k, t;
+   FILE *out;
+   int rc = 0;
+
+   if ( cache->new.numEntries == 0 )
+      return 0;
+   memset( &merged, 0, sizeof( merged ) );
+   from[0] = &cache->old;
+   from[1] = &cache->new;
+   for ( t = 0; t < 2; t++ )
+      for ( k = 0; from[t]->slots && k <= from[t]->mask; k++ )
+         if ( from[t]->slots[k].offset )
+         {
+            entry = from[t]->pool + from[t]->slots[k].offset;
+            entryLen = 1 + strlen( entry + 1 ) + 1;
+            entryLen += strlen( entry + entryLen ) + 1;
+            if ( cacheInsert( &merged, from[t]->slots[k].hash, entry, entryLen ) != 0 )
+               rc = -1;
+         }
+   if ( ( tmpPath = malloc( strlen( cache->path ) + 5 ) ) == NULL )
+      rc = -1;
+   else
+      sprintf( tmpPath, "%s.tmp", cache->path );
+   if ( rc == 0 && ( out = fopen( tmpPath, "wb" ) ) != NULL )
+   {
+      memset( &header, 0, sizeof( header ) );
+      memcpy( header.magic, CACHE_MAGIC, 8 );
+      header.version = CACHE_VERSION;
+      header.slotCount = (unsigned int) ( merged.mask + 1 );
+      header.fingerprint = cache->fingerprint;
+      header.numEntries = merged.numEntries;
+      header.poolSize = merged.poolSize;
+      if ( fwrite( &header, sizeof( header ), 1, out ) != 1
+           || fwrite( merged.slots, sizeof( *merged.slots ), merged.mask + 1, out ) != merged.mask + 1
+           || fwrite( merged.pool, 1, merged.poolSize, out ) != merged.poolSize )
+         rc = -1;
+      if ( fclose( out ) != 0 )
+         rc = -1;
+      if ( rc == 0 && rename( tmpPath, cache->path ) != 0 )
+         rc = -1;
+      if ( rc != 0 )
+         remove( tmpPath );
+   }
+   else
+      rc = -1;
+   free( tmpPath );
+   free( merged.slots );
+   free( merged.pool );
+   return rc;
+}
+
+/***************************** function cacheClose ******************************/
+
+static void cacheClose ( struct correctionCache *cache )
+{
+   if ( cache->map )
+      munmap( cache->map, cache->mapSize );
+   free( cache->new.slots );
+   free( cache->new.pool );
+   pthread_mutex_destroy( &cache->lock );
+   memset( cache, 0, sizeof( *cache ) );
+}
+
+/***************************** the compiled dictionary image ******************************/
+
+/* "autoSpell compile-dict dictionary image" reads the word list as usual and writes it out as a binary image that
+   can later be given as the dictionary (with either matcher): the image is recognised by its magic, mmap-ed read
+   only and used in place, so there is no parsing, sorting check or index building at start up.
+   layout (native byte order):  struct dictImageHeader, then the sections it lists, each starting on a 64 byte
+   boundary.  A section of size 0 is absent.
+      SECTION_WORDS        the dictionary arena: the words end to end, each followed by its '\0'
+      SECTION_OFFSETS      numWords + 1 unsigned int offsets of the words in the arena (see struct dictionary)
+      SECTION_FREQ         the frequency column, one unsigned int per word (if the word list has one)
+      SECTION_BK           the lev matcher's BK-tree, one struct bkNode per word (written with -i bk)
+      SECTION_SYM_SLOTS    the lev matcher's symmetric-delete hash table (written with -i sym)
+      SECTION_SYM_POSTING  and its postings
+      SECTION_HOLE_SLOTS   the sim matcher's hole index (written with --matcher sim unless -i scan)
+      SECTION_HOLE_POSTING and its postings
+      SECTION_DAWG         the lev matcher's DAWG, one struct dawgNode per node (written with -i dawg)
+      SECTION_DAWG_WORDS   and the dictionary index of each of its words (dawgWord)
+      SECTION_EXACT        the exact word table, always written
+   A program uses the sections it knows and builds at start up any index it needs that the image lacks. */
+
+#define IMAGE_MAGIC "ASPDICT"
+#define IMAGE_VERSION 6
+#define IMAGE_ALIGN 64
+
+enum imageSection { SECTION_WORDS, SECTION_OFFSETS, SECTION_FREQ, SECTION_BK, SECTION_SYM_SLOTS, SECTION_SYM_POSTING,
+                    SECTION_HOLE_SLOTS, SECTION_HOLE_POSTING, SECTION_DAWG, SECTION_DAWG_WORDS,
+                    SECTION_EXACT, NUM_SECTIONS };
+
+struct dictImageHeader
+{
+   char magic[8];
+   unsigned int version;
+   unsigned int maxl;                      // MAXL of the program that wrote the image
+   unsigned long long numWords;
+   unsigned long long lastWordSize;
+   unsigned long long dictHash;            // hash of every word, which the cache fingerprint is made from
+   unsigned long long symMask;             // number of slots - 1 of the symmetric-delete table, if present
+   unsigned long long holeMask;            // number of slots - 1 of the hole index, if present
+   unsigned long long dawgRoot;            // the first node of the DAWG, if present
+   unsigned long long exactMask;           // number of slots - 1 of the exact word table
+   long long wordLenIndex[MAXL + 2];
+   unsigned int wide[127];                 // the characters of the narrow bytes (see the characters)
+   unsigned int numWide;
+   unsigned long long offset[NUM_SECTIONS];
+   unsigned long long size[NUM_SECTIONS];
+};
+
+/***************************** function writeDictImage ******************************/
+
+#ifndef AUTOSPELL_NO_MAIN                  // only main writes an image
+
+static int writeDictImage ( const char *path, struct dictImageHeader *header, const void *section[NUM_SECTIONS] )
+{
+   /* function to write header (whose counts and section sizes the caller has filled in) and the sections to path.
+      The section offsets are worked out here.  Returns 0 on success, -1 on failure. */
+
+   static const char pad[IMAGE_ALIGN];
+   unsigned long long pos;
+   FILE *out;
+   int k, rc = 0;
+
+   memcpy( header->magic, IMAGE_MAGIC, 8 );
+   header->version = IMAGE_VERSION;
+   header->maxl = MAXL;
+   pos = ( sizeof( *header ) + IMAGE_ALIGN - 1 ) / IMAGE_ALIGN * IMAGE_ALIGN;
+   for ( k = 0; k < NUM_SECTIONS; k++ )
+   {
+      header->offset[k] = header->size[k] ? pos : 0;
+      pos += ( header->size[k] + IMAGE_ALIGN - 1 ) / IMAGE_ALIGN * IMAGE_ALIGN;
+   }
+   if ( ( out = fopen( path, "wb" ) ) == NULL )
+      return -1;
+   pos = sizeof( *header );
+   if ( fwrite( header, sizeof( *header ), 1, out ) != 1 )
+      rc = -1;
+   for ( k = 0; k < NUM_SECTIONS && rc == 0; k++ )
+   {
+      if ( header->size[k] == 0 )
+         continue;
+      if ( fwrite( pad, 1, (size_t) ( header->offset[k] - pos ), out ) != header->offset[k] - pos
+           || fwrite( section[k], 1, (size_t) header->size[k], out ) != header->size[k] )
+         rc = -1;
+      pos = header->offset[k] + header->size[k];
+   }
+   if ( fclose( out ) != 0 )
+      rc = -1;
+   if ( rc != 0 )
+      remove( path );
+   return rc;
+}
+
+#endif /* AUTOSPELL_NO_MAIN */
+
+/***************************** function mapDictImage ******************************/
+
+static int mapDictImage ( const char *path, void **map, size_t *mapSize )
+{
+   /* function to map the dictionary at path if it is a compiled image.  Returns 0 if it is (and *map, *mapSize
+      describe the mapping, which starts with struct dictImageHeader), 1 if path is not an image (a word list),
+      -1 if it is an image this program cannot use. */
+
+   const struct dictImageHeader *header;
+   struct stat st;
+   int fd, k;
+   char magic[8];
+
+   if ( ( fd = open( path, O_RDONLY ) ) == -1 )
+      return 1;                                              // let the word list code report it
+   if ( read( fd, magic, 8 ) != 8 || memcmp( magic, IMAGE_MAGIC, 8 ) != 0 || fstat( fd, &st ) != 0 )
+   {
+      close( fd );
+      return 1;
+   }
+   *mapSize = (size_t) st.st_size;
+   if ( *mapSize < sizeof( *header ) )
+   {
+      fprintf (stderr, "the dictionary image %s is truncated\n", path);
+      close( fd );
+      return -1;
+   }
+   *map = mmap( NULL, *mapSize, PROT_READ, MAP_PRIVATE, fd, 0 );
+   close( fd );
+   if ( *map == MAP_FAILED )
+   {
+      fprintf (stderr, "cannot map the dictionary image %s\n", path);
+      return -1;
+   }
+   header = *map;
+   for ( k = 0; k < NUM_SECTIONS; k++ )
+      if ( header->offset[k] % IMAGE_ALIGN != 0 || header->offset[k] + header->size[k] > *mapSize )
+         break;
+   if ( header->version != IMAGE_VERSION || header->maxl != MAXL || k < NUM_SECTIONS
+        || header->size[SECTION_OFFSETS] != ( header->numWords + 1 ) * sizeof( unsigned int ) )
+   {
+      fprintf (stderr, "the dictionary image %s was made by another version of this program; compile it again\n", path);
+      munmap( *map, *mapSize );
+      return -1;
+   }
+   if ( ( (const unsigned int *) ( (const char *) *map + header->offset[SECTION_OFFSETS] ) )[header->numWords]
+        != header->size[SECTION_WORDS] )
+   {
+      fprintf (stderr, "the dictionary image %s is damaged\n", path);
+      munmap( *map, *mapSize );
+      return -1;
+   }
+   return 0;
+}
+
+/***************************** function readWordList ******************************/
+
+static int narrowDictWord ( struct dictionary *dict, const long int i, const long int bytes )
+{
+   /* function to turn the word just read (word i, bytes long, not yet entered) into its narrow form in place,
+      giving the narrow bytes of its new characters.  Returns its number of characters, -1 if that is more than
+      MAXL or -2 if the dictionary already has as many different characters as there are narrow bytes. */
+
+   unsigned char *s = (unsigned char *) dict->arena + dict->offset[i];
+   size_t k = 0;
+   unsigned int cp;
+   int n = 0;
+
+   if ( isAscii( (const char *) s, (size_t) bytes ) )
+      return bytes > MAXL ? -1 : (int) bytes;
+   if ( charCount( (const char *) s, (size_t) bytes ) > MAXL )
+      return -1;
+   while ( k < (size_t) bytes )
+   {
+      cp = s[k] < 0x80 ? s[k++] : utf8Next( s, (size_t) bytes, &k );
+      if ( cp >= 0x80 && ( cp = narrowAdd( dict, cp ) ) == 0 )
+         return -2;
+      s[n++] = (unsigned char) cp;                          // never ahead of k
+   }
+   s[n] = '\0';
+   dict->offset[i + 1] = dict->offset[i] + (unsigned int) n + 1;
+   dict->arenaSize = dict->offset[i + 1];
+   return n;
+}
+
+struct sortKey                     // a word being put in order by sortWords
+{
+   int len;
+   unsigned int freq;
+   long int i;
+};
+
+static int compareSortKeys ( const void *a, const void *b )
+{
+   // function for qsort to order words by length, then by frequency from highest to lowest, then as they were
+
+   const struct sortKey *x = a, *y = b;
+
+   if ( x->len != y->len )
+      return x->len < y->len ? -1 : 1;
+   if ( x->freq != y->freq )
+      return x->freq > y->freq ? -1 : 1;
+   return x->i < y->i ? -1 : x->i > y->i;
+}
+
+static int sortWords ( struct dictionary *dict )
+{
+   /* function to put the words of dict in order of length (in characters) and, if the list has a frequency
+      column, from the most to the least frequent within a length, otherwise keeping the order of the words of
+      each length.  Returns 0 or -2 if memory ran out. */
+
+   struct sortKey *key;
+   long int i;
+   size_t nextByte = 0;                    // where the next word goes in the new arena
+   char *arena;
+   unsigned int *offset = NULL, *freq = NULL;
+
+   if ( ( key = malloc( ( (size_t) dict->numWords + 1 ) * sizeof( *key ) ) ) == NULL )
+      return -2;
+   for ( i = 0; i < dict->numWords; i++ )
+   {
+      key[i].len = dictLength( dict, i );
+      key[i].freq = dict->freq ? dict->freq[i] : 0;
+      key[i].i = i;
+   }
+   qsort( key, (size_t) dict->numWords, sizeof( *key ), compareSortKeys );
+   if ( ( arena = malloc( dict->offset[dict->numWords] + 1 ) ) == NULL
+        || ( offset = malloc( ( (size_t) dict->numWords + 1 ) * sizeof( *offset ) ) ) == NULL
+        || ( dict->freq && ( freq = malloc( ( (size_t) dict->numWords + 1 ) * sizeof( *freq ) ) ) == NULL ) )
+   {
+      free( key );
+      free( arena );
+      free( offset );
+      return -2;
+   }
+   for ( i = 0; i < dict->numWords; i++ )
+   {
+      offset[i] = (unsigned int) nextByte;
+      memcpy( arena + nextByte, dictWord( dict, key[i].i ), (size_t) key[i].len + 1 );
+      nextByte += (size_t) key[i].len + 1;
+      if ( freq )
+         freq[i] = key[i].freq;
+   }
+   offset[dict->numWords] = dict->offset[dict->numWords];
+   free( key );
+   free( dict->arena );
+   free( dict->offset );
+   free( dict->freq );
+   dict->arena = arena;
+   dict->offset = offset;
+   dict->freq = freq;
+   dict->arenaSize = dict->arenaCap = offset[dict->numWords] + 1;
+   dict->offsetCap = dict->numWords + 1;
+   return 0;
+}
+
+static long int readWordList ( FILE *wordList, struct dictionary *dict, long int *wordLenIndex, size_t *lastWordSize,
+                               unsigned long long *dictHash )
+{
+   /* function to read the whole column of dictionary words into dict (which is empty) and fill in wordLenIndex,
+      the length of the longest word and the hash of all the words.  wordLenIndex must be all 0 on entry.
+      The words are narrowed as they are read (see the characters) and measured in characters.  The list may be
+      sorted by length in characters or in bytes (as a UTF-8 list sorted in the C locale is); in bytes, the words
+      are then put in order of characters here.  A word may be followed on its line by its count (the first
+      column of make_word_list.sh), which is kept in dict->freq; the words of each length are then put in order
+      of frequency here, so the list need only be sorted by length.
+      Returns 0, -1 if the words are not sorted by length, -2 if memory ran out or -3 if the words have more
+      different non-ASCII characters than there are narrow bytes. */
+
+   long int wordSize;
+   long int numWords = 0;
+   long int lastBytes = 0, lastChars = 0;
+   int chars;
+   _Bool byChars = 1, byBytes = 1;
+   unsigned long long hash;
+   long long count;                        // of the word in the frequency column, -1 if it has none
+   unsigned int freq;
+
+   while ( ( wordSize = readDictWord( wordList, dict, &count ) ) >= 0 )  // loop to read in the column of dictionary words
+   {
+      hash = hashMore( *dictHash, dictWord( dict, numWords ), (size_t) wordSize + 1 );
+      if ( count >= 0 && dict->freq == NULL && ( dict->freq = calloc( (size_t) dict->offsetCap, sizeof( *dict->freq ) ) ) == NULL )
+         return -2;                        // the first count: the words before it have none
+      if ( dict->freq )
+      {
+         freq = count >= 0 ? (unsigned int) count : 0;
+         hash = hashMore( hash, (const char *) &freq, sizeof( freq ) );
+         dict->freq[numWords] = freq;
+      }
+      if ( ( chars = narrowDictWord( dict, numWords, wordSize ) ) == -2 )
+         return -3;
+      if ( chars < 0 )
+         continue;                      // could never be matched: input words longer than MAXL are not searched
+      if ( wordSize < lastBytes )
+         byBytes = 0;
+      if ( chars < lastChars )
+         byChars = 0;
+      if ( !byBytes && !byChars )
+         return -1;
+      lastBytes = wordSize;
+      lastChars = chars;
+      *dictHash = hash;
+      numWords = ++dict->numWords;
+   }
+   if ( wordSize == -2 || ( ( !byChars || dict->freq ) && sortWords( dict ) != 0 ) )
+      return -2;
+   for ( numWords = 0; numWords < dict->numWords; numWords++ )
+      if ( dictLength( dict, numWords ) > (int) *lastWordSize )
+      {
+         *lastWordSize = (size_t) dictLength( dict, numWords );
+         wordLenIndex[*lastWordSize] = numWords;
+         /*wordLenIndex stores the index of the dictionary using its own index equal to the first occurance of strlen(x).
+           The word length is increasing in the sorted word list we are reading in.  So, if, for example, the first time 
+           the program encounters a word of length 7 is at the 116th word read in then wordLenIndex[7] = 116.  If no words
+           are of length 7 then wordLenIndex[7] stays initialized at 0 which is a flag for later use.  This wordLenIndex array
+           will speed up the search for similiar words since we still know where in the word list to start and stop looking. */
+      }
+   wordLenIndex[0] = numWords;   //  convenient place to store size of array
+   return 0;
+}
+
+/***************************** function searchLev ******************************/
+
+static _Bool searchLev ( char *outputWord, const char *givenWord, const int wordLen, const struct dictionary *dict,
+                         const long int *wordLenIndex, const struct searchIndex *index )
+{
+   /* function for the lev matcher: copy to outputWord the first dictionary word of wordLen characters nearest to
+      givenWord by edit distance, if it is within maxEdits(wordLen).  index->mode selects whether the words of the
+      same length are scanned one by one or found through the BK-tree, the symmetric-delete index or the DAWG.
+      Returns true if outputWord was corrected to another word. */
+
+   struct levPattern pattern;                                // givenWord made ready for levenshteinBits
+   struct matchQuery query;
+   long int i;
+   long int startIndex = wordLenIndex[wordLen];              // starting index to search in the dictionary
+   long int endIndex = bucketEnd( wordLenIndex, wordLen );   // ending index to search in the dictionary
+   long int bestIndex = -1;                                  // index in the dictionary of the best match
+   int maxED = maxEdits( wordLen );                          // maximum permissible edit distance for a word to match
+   int lastSR = maxED + 1;
+   int levResult = -1;
+
+   levPrepare( &pattern, givenWord );
+   query.word = givenWord;
+   query.pattern = &pattern;
+   query.enough = index->exact.slots ? 1 : 0;               // returnWord looked givenWord up in the exact table
+   if ( index->mode == INDEX_BK )
+   {
+      lastSR = maxED;
+      bkSearch( index, dict, startIndex, &pattern, &lastSR, &bestIndex );
+      if ( bestIndex == -1 )
+         lastSR = maxED + 1;
+   }
+   else if ( index->mode == INDEX_SYM )
+      bestIndex = symSearch( index, dict, &pattern, maxED, startIndex, endIndex, &lastSR );
+   else if ( index->mode == INDEX_DAWG )
+   {
+      lastSR = maxED;
+      if ( ( bestIndex = dawgSearch( index, givenWord, wordLen, &lastSR ) ) == -1 )
+         lastSR = maxED + 1;
+   }
+   if ( bestIndex >= 0 )
+      strcpy( outputWord, dictWord( dict, bestIndex ) );
+   else if ( index->mode == INDEX_SCAN || bestIndex == -2 )
+   {
+      i = startIndex;
+      if ( index->kernel == KERNEL_SIMD && index->levBlock && index->transposed[wordLen].chars )
+      {
+         const struct transposedBucket *tb = &index->transposed[wordLen];
+         unsigned char dist[LANES];
+         long int lane, block;
+
+         for ( block = 0; block * LANES < tb->count && lastSR > query.enough; block++ )
+         {
+            index->levBlock( givenWord, wordLen, tb->chars + block * wordLen * LANES, dist );
+            for ( lane = 0; lane < LANES && block * LANES + lane < tb->count && lastSR > query.enough; lane++ )
+            {
+               levResult = dist[lane];
+               if ( levResult < lastSR )
+               {
+                  strcpy( outputWord, dictWord( dict, tb->start + block * LANES + lane ) );
+                  lastSR = levResult;
+               }
+            }
+         }
+         threadStats.comparisons += block * LANES < tb->count ? block * LANES : tb->count;
+         i = tb->start + tb->count;                          // any words left in the bucket are compared one by one
+      }
+      if ( index->kernel == KERNEL_DP )
+         bestIndex = scanLevDp( &query, dict, i, endIndex, &lastSR );
+      else
+         bestIndex = scanLevBit( &query, dict, i, endIndex, &lastSR );
+      if ( bestIndex >= 0 )
+         strcpy( outputWord, dictWord( dict, bestIndex ) );
+   }
+   threadStats.searches++;
+   threadStats.found[lastSR <= maxED ? lastSR : MAXL + 1]++;
+   return (_Bool) ( 0 < lastSR && lastSR <= maxED );
+}
+
+/***************************** function searchSim ******************************/
+
+static _Bool searchSim ( char *outputWord, const char *givenWord, const int wordLen, const struct dictionary *dict,
+                         const long int *wordLenIndex, const struct searchIndex *index )
+{
+   /* function for the sim matcher: copy to outputWord the dictionary word of wordLen characters identical to
+      givenWord or else the first word of wordLen - 1 or wordLen characters that simWords finds similar to it,
+      found through the hole index or by scanning both buckets (-i scan).
+      Returns true if outputWord was corrected to a similar word. */
+
+   struct matchQuery query = { givenWord, NULL, 2 };
+   long int startIndex;                                      // starting index to search in the dictionary
+   long int endIndex = bucketEnd( wordLenIndex, wordLen );   // ending index to search in the dictionary
+   long int bestIndex = -2;
+   int lastSR = 0;
+
+   if ( wordLenIndex[wordLen - 1] )                          // if smaller words exists in dictionary start looking there 
+      startIndex = wordLenIndex[wordLen - 1];
+   else
+      startIndex = wordLenIndex[wordLen];
+   if ( index->exact.slots )
+      query.enough = 1;                                      // returnWord looked givenWord up in the exact table
+   if ( index->mode == INDEX_HOLE )
+      bestIndex = holeSearch( index, dict, givenWord, wordLen, startIndex, endIndex, query.enough, &lastSR );
+   if ( bestIndex == -2 )
+   {
+      lastSR = 0;
+      bestIndex = scanSim( &query, dict, startIndex, endIndex, &lastSR );
+   }
+   if ( bestIndex >= 0 )
+      strcpy( outputWord, dictWord( dict, bestIndex ) );
+   threadStats.searches++;
+   threadStats.found[lastSR]++;
+   return (_Bool) ( lastSR == 1 );
+}
+
+/***************************** function returnWord ******************************/
+
+static int returnWord (char *outputWord, const char *inputWord, const int inputWrdLen, const struct dictionary *dict,
+                       const long int *wordLenIndex,
+                       const struct searchIndex *index, struct correctionCache *cache, long int *correctedWrdCt )
+
+/* This function hands inputWord to the matcher chosen by --matcher: searchLev sends it dictionary words of the
+   same length to levenshtein, searchSim sends it words of equal and one less character than inputWord to
+   simWords because sometimes ocr programs make two letters out of one like h -> li, and searchOcr weighs the
+   edits of words of any length by how likely ocr is to make them.  A word in the dictionary is left as it is
+   without a search (see the exact word table).
+   inputWord is the inputWrdLen bytes (at most MAXL characters) of a word in the text, not null-terminated; it is
+   narrowed here (see the characters) and its first letter made small if it is a capital, which is restored on
+   the correction.  outputWord (room for MAXB + 1) gets the correction in UTF-8, or else inputWord as it is.
+   If cache is not NULL it is asked first and told the result of any search made.
+*/
+
+{
+char givenWord[MAXL + 1];                                    // the inputWord narrowed and subject to modification
+char foundWord[MAXL + 1];                                    // the narrow word the search or the cache gave
+int wordLen;                                                 // characters of inputWord
+_Bool capitalized;                                           // true if inputWord has 1st letter capitalized
+_Bool corrected;                                             // by the search or as remembered by the cache
+
+threadStats.calls++;
+memcpy( outputWord, inputWord, (size_t) inputWrdLen );        // default return word
+outputWord[inputWrdLen] = '\0';
+if ( ( wordLen = narrowWord( dict, inputWord, (size_t) inputWrdLen, givenWord, &capitalized ) ) < 0 )
+   return 0;
+if ( index->matcher == MATCHER_SIM )
+{
+   if ( wordLen < 2 )                                        // ridiculous to auto-correct tiny words
+      return 0;
+   if ( wordLenIndex[wordLen] == 0 && wordLenIndex[wordLen - 1] == 0 )
+      return 0;                                              // there are no available dictionary words that could match
+}
+else
+{
+   if ( wordLen <= 4 )
+      return 0;
+   if ( index->matcher == MATCHER_LEV && wordLenIndex[wordLen] == 0 )
+      return 0;                                              // (ocr may correct to a word of another length)
+}
+
+if ( index->exact.slots && exactFind( &index->exact, dict, givenWord, wordLen ) )
+{
+   threadStats.members++;
+   return 1;
+}
+if ( !cache || !cacheLookup( cache, givenWord, foundWord, &corrected ) )
+{
+   strcpy( foundWord, givenWord );                           // same as inputWord once capitalization is restored
+   if ( index->matcher == MATCHER_SIM )
+      corrected = searchSim( foundWord, givenWord, wordLen, dict, wordLenIndex, index );
+   else if ( index->matcher == MATCHER_OCR )
+      corrected = searchOcr( foundWord, givenWord, wordLen, dict, index );
+   else
+      corrected = searchLev( foundWord, givenWord, wordLen, dict, wordLenIndex, index );
+   if ( cache )
+      cacheAdd( cache, givenWord, foundWord, corrected );
+}
+else
+   threadStats.cacheHits++;
+
+if ( corrected )
+{
+   (*correctedWrdCt)++;
+   widenWord( dict, foundWord, outputWord, capitalized );
+}
+return 1;
+}
+
+
+/***************************** function correctLine ******************************/
+
+struct lineContext                         // what correctLine needs besides the line itself
+{
+   const unsigned char *delimTable;        // from makeDelimTable
+   size_t minCharWord;                     // the minimum number characters in a word to search for similar words
+   size_t lastWordSize;                    // length of the longest dictionary word
+   const struct dictionary *dict;
+   long int *wordLenIndex;
+   const struct searchIndex *index;        // how to search the dictionary (options -i and -k)
+   struct correctionCache *cache;          // NULL if there is no cache (option -c)
+   struct runStats *stats;                 /* option --stats: where the worker threads add their threadStats, and
+                                              time the work of each word; NULL without --stats */
+};
+
+static void correctLine ( const struct lineContext *ctx, const char *line, const size_t lineLen, FILE *out,
+                          long int *corrWrdCt, long int *return_code )
+{
+   /* function to print to out the lineLen characters of line (not null-terminated, normally ending with its
+      newline) with its words corrected.  Words and delimiters are printed straight from line; only the words
+      handed to returnWord are copied.  *return_code is set to -5 or -6 when a delimiter string or a word is
+      longer than MAXL (and is printed without processing).  With --stats the time taken by nextToken, returnWord
+      and the printing are added to threadStats. */
+
+   struct tokenSpan span;                  // run of delimiters or word found on the line
+   size_t cursor = 0;                      // where nextToken looks for the next run on the line
+   char simOrSame[MAXB + 1];               // returned word from function returnWord
+   size_t chars;                           // characters of the word
+   _Bool ascii;                            // the line is all ASCII, so its words are as many characters as bytes
+   struct timespec last;                   // --stats: when the last lap ended
+
+   if ( lineLen < ctx->minCharWord )
+   {
+      if ( ctx->stats )                    // the words are counted, though none can be long enough to search
+         while ( nextToken( ctx->delimTable, line, lineLen, &cursor, &span ) )
+            if ( span.isWord )
+            {
+               threadStats.words++;
+               threadStats.shortWords++;
+            }
+      fwrite( line, 1, lineLen, out );
+      return;
+   }
+   ascii = isAscii( line, lineLen );
+   if ( ctx->stats )
+      clock_gettime( CLOCK_MONOTONIC, &last );
+   while ( nextToken( ctx->delimTable, line, lineLen, &cursor, &span ) )  // loop to process all words on a line
+   {
+      if ( ctx->stats )
+         statsLap( &threadStats.tokenizeTime, &last );
+      if ( ! span.isWord )                                   // delimiters are just printed
+      {
+         if ( span.length > MAXL )
+            *return_code = -5;
+         fwrite( line + span.offset, 1, span.length, out );
+         if ( ctx->stats )
+            statsLap( &threadStats.outputTime, &last );
+         continue;
+      }
+      threadStats.words++;
+      chars = ascii ? span.length : charCount( line + span.offset, span.length );
+      if ( chars > MAXL )
+      {
+         fwrite( line + span.offset, 1, span.length, out );
+         *return_code = -6;
+         threadStats.longWords++;
+      }
+      else if ( chars < ctx->minCharWord || chars > ctx->lastWordSize )  // just print words too short or too long
+      {
+         fwrite( line + span.offset, 1, span.length, out );
+         if ( chars < ctx->minCharWord )
+            threadStats.shortWords++;
+         else
+            threadStats.longWords++;
+      }
+      else                                                   // the common condition, where words get processed for correction
+      {
+         (void) returnWord( simOrSame, line + span.offset, (int) span.length, ctx->dict, ctx->wordLenIndex,
+                            ctx->index, ctx->cache, corrWrdCt );
+         if ( ctx->stats )
+            statsLap( &threadStats.searchTime, &last );
+         fputs( simOrSame, out );
+      }
+      if ( ctx->stats )
+         statsLap( &threadStats.outputTime, &last );
+   }
+}
+
+
+/***************************** function correctText ******************************/
+
+static void correctText ( const struct lineContext *ctx, const char *text, const size_t textLen, FILE *out,
+                          long int *corrWrdCt, long int *return_code )
+{
+   // function to correct the textLen characters of text (a whole file or a chunk of whole lines) line by line
+
+   const char *lineStart, *lineEnd;
+
+   for ( lineStart = text; lineStart < text + textLen; lineStart = lineEnd )
+   {
+      if ( ( lineEnd = memchr( lineStart, '\n', (size_t) ( text + textLen - lineStart ) ) ) == NULL )
+         lineEnd = text + textLen;
+      else
+         lineEnd++;
+      correctLine( ctx, lineStart, (size_t) ( lineEnd - lineStart ), out, corrWrdCt, return_code );
+   }
+}
+
+/***************************** function correctParallel ******************************/
+
+#ifndef AUTOSPELL_NO_MAIN                  // from here to the library only main uses
+
+struct chunk                               // a piece of the text made of whole lines, corrected by one worker
+{
+   const char *text;
+   size_t textLen;
+   char *out;                              // the corrected chunk (from open_memstream)
+   size_t outLen;
+   long int corrWrdCt;                     // corrections made in this chunk
+   long int return_code;                   // 1, or -5 / -6 as set by correctLine
+   _Bool done;
+};
+
+struct pipeline                            // shared by the workers of correctParallel
+{
+   const struct lineContext *ctx;
+   struct chunk *chunks;
+   long int numChunks;
+   long int nextChunk;                     // the next chunk a worker may take
+   long int nextToWrite;                   // the next chunk the main thread is waiting to print
+   long int window;                        // how many chunks may be corrected ahead of the printing
+   pthread_mutex_t lock;
+   pthread_cond_t cond;
+};
+
+static void *chunkWorker ( void *arg )
+{
+   // function run by each worker thread: take the next chunk, correct it into memory, repeat
+
+   struct pipeline *pl = arg;
+   struct chunk *c;
+   FILE *out;
+   long int k;
+
+   while ( 1 )
+   {
+      pthread_mutex_lock( &pl->lock );
+      while ( pl->nextChunk < pl->numChunks && pl->nextChunk >= pl->nextToWrite + pl->window )
+         pthread_cond_wait( &pl->cond, &pl->lock );
+      k = pl->nextChunk++;
+      if ( k >= pl->numChunks && pl->ctx->stats )
+         statsAdd( pl->ctx->stats, &threadStats );          // this thread's counts, before it ends
+      pthread_mutex_unlock( &pl->lock );
+      if ( k >= pl->numChunks )
+         return NULL;
+      c = &pl->chunks[k];
+      c->corrWrdCt = 0;
+      c->return_code = 1;
+      if ( ( out = open_memstream( &c->out, &c->outLen ) ) == NULL )
+         c->out = NULL;
+      else
+      {
+         correctText( pl->ctx, c->text, c->textLen, out, &c->corrWrdCt, &c->return_code );
+         if ( fclose( out ) != 0 )
+         {
+            free( c->out );
+            c->out = NULL;
+         }
+      }
+      pthread_mutex_lock( &pl->lock );
+      c->done = (_Bool) 1;
+      pthread_cond_broadcast( &pl->cond );
+      pthread_mutex_unlock( &pl->lock );
+   }
+}
+
+static int correctParallel ( const struct lineContext *ctx, const char *text, const size_t textLen,
+                             const int numThreads, FILE *out, long int *corrWrdCt, long int *return_code )
+{
+   /* function to correct text with numThreads worker threads.  The text is cut into chunks of whole lines, the
+      workers correct the chunks into memory against the shared (read only) dictionary and the chunks are printed
+      to out in their original order as they become ready, so the output is the same as correctText would give.
+      The corrections counted in each chunk are added to *corrWrdCt and *return_code is set as a single thread
+      would have left it.  Returns 0 on success, -1 if threads or memory could not be had. */
+
+   struct pipeline pl;
+   pthread_t *threads;
+   size_t chunkLen, pos;
+   const char *end;
+   long int k;
+   int t, started = 0, rc = 0;
+
+   chunkLen = textLen / ( 8 * (size_t) numThreads ) + 1;     // several chunks a thread to even out the work
+   if ( chunkLen < 65536 )
+      chunkLen = 65536;
+   pl.ctx = ctx;
+   pl.numChunks = (long int) ( textLen / chunkLen + 1 );
+   pl.nextChunk = pl.nextToWrite = 0;
+   pl.window = 4 * numThreads;
+   pl.chunks = calloc( (size_t) pl.numChunks, sizeof( *pl.chunks ) );
+   threads = malloc( (size_t) numThreads * sizeof( *threads ) );
+   if ( pl.chunks == NULL || threads == NULL )
+   {
+      free( pl.chunks );
+      free( threads );
+      return -1;
+   }
+   for ( k = 0, pos = 0; pos < textLen; k++ )                // chunk ends are moved to the end of a line
+   {
+      pl.chunks[k].text = text + pos;
+      if ( textLen - pos <= chunkLen || ( end = memchr( text + pos + chunkLen, '\n', textLen - pos - chunkLen ) ) == NULL )
+         pos = textLen;
+      else
+         pos = (size_t) ( end + 1 - text );
+      pl.chunks[k].textLen = (size_t) ( text + pos - pl.chunks[k].text );
+   }
+   pl.numChunks = k;
+   pthread_mutex_init( &pl.lock, NULL );
+   pthread_cond_init( &pl.cond, NULL );
+   for ( t = 0; t < numThreads; t++ )
+      if ( pthread_create( &threads[t], NULL, chunkWorker, &pl ) == 0 )
+         started++;
+   if ( started == 0 )
+      rc = -1;
+   for ( k = 0; k < pl.numChunks && rc == 0; k++ )
+   {
+      pthread_mutex_lock( &pl.lock );
+      while ( ! pl.chunks[k].done )
+         pthread_cond_wait( &pl.cond, &pl.lock );
+      pthread_mutex_unlock( &pl.lock );
+      if ( pl.chunks[k].out == NULL )
+         rc = -1;
+      else
+      {
+         fwrite( pl.chunks[k].out, 1, pl.chunks[k].outLen, out );
+         *corrWrdCt += pl.chunks[k].corrWrdCt;
+         if ( pl.chunks[k].return_code != 1 )
+            *return_code = pl.chunks[k].return_code;
+      }
+      free( pl.chunks[k].out );
+      pl.chunks[k].out = NULL;
+      pthread_mutex_lock( &pl.lock );
+      pl.nextToWrite = k + 1;
+      pthread_cond_broadcast( &pl.cond );
+      pthread_mutex_unlock( &pl.lock );
+   }
+   pthread_mutex_lock( &pl.lock );                           // on failure let the workers run out of chunks
+   pl.nextToWrite = pl.numChunks;
+   pthread_cond_broadcast( &pl.cond );
+   pthread_mutex_unlock( &pl.lock );
+   for ( t = 0; t < started; t++ )
+      pthread_join( threads[t], NULL );
+   for ( k = 0; k < pl.numChunks; k++ )
+      free( pl.chunks[k].out );
+   pthread_mutex_destroy( &pl.lock );
+   pthread_cond_destroy( &pl.cond );
+   free( pl.chunks );
+   free( threads );
+   return rc;
+}
+
+/***************************** function correctStream ******************************/
+
+#define STREAM_BLOCK ( 1 << 20 )           // bytes of the text read at a time by correctStream, for each thread
+
+static int correctStream ( const struct lineContext *ctx, FILE *in, const int numThreads, FILE *out,
+                           long int *corrWrdCt, long int *return_code )
+{
+   /* function to correct the text read from in (a pipe or a file that is not mapped) in blocks of STREAM_BLOCK
+      bytes for each thread, so the memory used stays the same however long the text is.  Each block is cut after
+      its last whole line and corrected with correctText (or correctParallel); the rest is carried over to the
+      start of the next block.  A block without a newline is cut before the run of delimiters or word it ends in,
+      so a word is never split.  A run that fills a whole block is longer than MAXL and so is printed as it is,
+      together with the rest of it in the next blocks, and *return_code is set to -5 or -6 as correctLine would.
+      Returns 0 on success, -1 if memory or threads could not be had. */
+
+   size_t blockSize = (size_t) STREAM_BLOCK * (size_t) numThreads;
+   size_t carry = 0;                       // bytes of the previous block not corrected yet, now at the start of buf
+   size_t got, have, cut, k;
+   char *buf;
+   int rawRun = -1;                        // delimTable value of an overlong run being printed as it is (-1 none)
+   int rc = 0;
+   _Bool atEnd = 0;
+
+   if ( ( buf = malloc( blockSize ) ) == NULL )
+      return -1;
+   while ( ! atEnd && rc == 0 )
+   {
+      got = fread( buf + carry, 1, blockSize - carry, in );
+      have = carry + got;
+      atEnd = (_Bool) ( got < blockSize - carry );
+      k = 0;
+      if ( rawRun >= 0 )                   // the rest of an overlong run
+      {
+         while ( k < have && ctx->delimTable[(unsigned char) buf[k]] == rawRun )
+            k++;
+         fwrite( buf, 1, k, out );
+         if ( k < have )
+            rawRun = -1;
+      }
+      if ( k == have )
+      {
+         carry = 0;
+         continue;
+      }
+      if ( atEnd )
+         cut = have;
+      else
+      {
+         for ( cut = have; cut > k && buf[cut - 1] != '\n'; cut-- )
+            ;
+         if ( cut == k )                   // no newline: keep the last run for the next block
+            for ( cut = have - 1; cut > k && ctx->delimTable[(unsigned char) buf[cut - 1]]
+                                             == ctx->delimTable[(unsigned char) buf[have - 1]]; cut-- )
+               ;
+         if ( cut == 0 )                   // one run fills the whole block
+         {
+            rawRun = ctx->delimTable[(unsigned char) buf[k]];
+            *return_code = rawRun ? -5 : -6;
+            if ( ! rawRun )
+            {
+               threadStats.words++;
+               threadStats.longWords++;
+            }
+            fwrite( buf + k, 1, have - k, out );
+            carry = 0;
+            continue;
+         }
+      }
+      if ( numThreads > 1 )
+         rc = correctParallel( ctx, buf + k, cut - k, numThreads, out, corrWrdCt, return_code );
+      else
+         correctText( ctx, buf + k, cut - k, out, corrWrdCt, return_code );
+      carry = have - cut;
+      memmove( buf, buf + cut, carry );
+   }
+   free( buf );
+   return rc;
+}
+
+/***************************** the manifest ******************************/
+
+/* --manifest file (with -o output_file) makes a long run resumable and a run over an edited text incremental.  The
+   text, which must be a file that can be mapped, is cut into blocks of whole lines: a block ends at the end of the
+   first line after MANIFEST_MIN_BLOCK bytes whose hash has its low bits all 0 (or after MANIFEST_MAX_BLOCK bytes),
+   so the cuts depend on the text around them and not on where the block started, and after an edit the blocks
+   fall back into step with those of the previous run at the next cut.  The corrected text is written to
+   output_file.part and each block, once its output is written, is added to file.part as one line
+
+      inOffset inLength inHash outOffset outLength outHash corrections returnCode
+
+   (the hashes in hexadecimal, returnCode 1 or the -5 or -6 of the block), after a first line
+   "autoSpell-manifest 1 fingerprint" tying it to the dictionary and the matching settings as the cache is.  When
+   the text is done the two .part files are renamed to output_file and file.
+
+   --resume carries on from output_file.part and file.part: the blocks of file.part that still match the text and
+   whose output is intact in output_file.part are kept, and the correction goes on from the end of the last of
+   them; the first line and the kept blocks are written to file.part.new, synced and renamed over file.part before
+   any new block is corrected, so a run stopped at any point leaves file.part describing everything it had done.
+   A block of the text that has the length and hash of a block of the previous complete run (file and
+   output_file) is not corrected again: its output is copied from output_file. */
+
+#define MANIFEST_MAGIC "autoSpell-manifest"
+#define MANIFEST_VERSION 1
+#define MANIFEST_MIN_BLOCK ( 1 << 18 )     // bytes of the text before a block may end
+#define MANIFEST_MAX_BLOCK ( 1 << 22 )     // bytes after which a block ends at the next line end
+#define MANIFEST_CUT_MASK 1023             // a block ends at a line whose hash has these bits 0
+
+struct manifestBlock                       // one line of a manifest
+{
+   unsigned long long inOffset, inLength, inHash;      // the block of the text
+   unsigned long long outOffset, outLength, outHash;   // and its corrected output
+   long int corrections;
+   long int returnCode;                    // 1, or -5 or -6 if it had overlong runs
+};
+
+/***************************** function manifestCut ******************************/
+
+static size_t manifestCut ( const char *text, const size_t textLen, const size_t start )
+{
+   // function to return where the block of text that starts at start ends
+
+   const char *nl;
+   size_t k = start, lineStart;
+
+   for ( ;; )
+   {
+      lineStart = k;
+      if ( ( nl = memchr( text + k, '\n', textLen - k ) ) == NULL )
+         return textLen;
+      k = (size_t) ( nl - text ) + 1;
+      if ( k - start >= MANIFEST_MAX_BLOCK )
+         return k;
+      if ( k - start >= MANIFEST_MIN_BLOCK
+           && ( hashMore( 14695981039346656037ULL, text + lineStart, k - lineStart ) & MANIFEST_CUT_MASK ) == 0 )
+         return k;
+   }
+}
+
+/***************************** function manifestRead ******************************/
+
+static long int manifestRead ( const char *path, const unsigned long long fingerprint, struct manifestBlock **blocks )
+{
+   /* function to read the blocks of the manifest at path into *blocks (to be freed).  Returns their number: 0 if
+      the file does not exist or was made with another fingerprint, or -1 if memory ran out.  A last line cut
+      short by a crash is left out. */
+
+   FILE *f;
+   char line[256];
+   char magic[32];
+   unsigned long long print;
+   int version;
+   long int num = 0, cap = 0;
+   struct manifestBlock b, *grown;
+
+   *blocks = NULL;
+   if ( ( f = fopen( path, "r" ) ) == NULL )
+      return 0;
+   if ( fgets( line, sizeof( line ), f ) == NULL || sscanf( line, "%31s %d %llx", magic, &version, &print ) != 3
+        || strcmp( magic, MANIFEST_MAGIC ) != 0 || version != MANIFEST_VERSION || print != fingerprint )
+   {
+      fclose( f );
+      return 0;
+   }
+   while ( fgets( line, sizeof( line ), f ) != NULL && strchr( line, '\n' ) != NULL
+           && sscanf( line, "%llu %llu %llx %llu %llu %llx %ld %ld", &b.inOffset, &b.inLength, &b.inHash, &b.outOffset,
+                      &b.outLength, &b.outHash, &b.corrections, &b.returnCode ) == 8 )
+   {
+      if ( num == cap )
+      {
+         if ( ( grown = realloc( *blocks, ( cap ? 2 * cap : 256 ) * sizeof( **blocks ) ) ) == NULL )
+         {
+            fclose( f );
+            free( *blocks );
+            *blocks = NULL;
+            return -1;
+         }
+         *blocks = grown;
+         cap = cap ? 2 * cap : 256;
+      }
+      ( *blocks )[num++] = b;
+   }
+   fclose( f );
+   return num;
+}
+
+/***************************** function correctManifest ******************************/
+
+static int compareBlocks ( const void *a, const void *b )
+{
+   // function for qsort and bsearch to order blocks by the hash and then the length of their text
+
+   const struct manifestBlock *x = a, *y = b;
+
+   if ( x->inHash != y->inHash )
+      return x->inHash < y->inHash ? -1 : 1;
+   return x->inLength < y->inLength ? -1 : x->inLength > y->inLength;
+}
+
+static const char *mapOutput ( const char *path, size_t *size )
+{
+   // function to map the file at path read only; returns NULL (and *size 0) if it is missing or empty
+
+   int fd;
+   struct stat st;
+   void *map;
+
+   *size = 0;
+   if ( ( fd = open( path, O_RDONLY ) ) < 0 )
+      return NULL;
+   if ( fstat( fd, &st ) != 0 || st.st_size == 0
+        || ( map = mmap( NULL, (size_t) st.st_size, PROT_READ, MAP_PRIVATE, fd, 0 ) ) == MAP_FAILED )
+   {
+      close( fd );
+      return NULL;
+   }
+   close( fd );
+   *size = (size_t) st.st_size;
+   return map;
+}
+
+static int hashWritten ( FILE *out, const unsigned long long offset, const unsigned long long length,
+                         unsigned long long *hash )
+{
+   // function to hash the length bytes of out (flushed) from offset into *hash; returns 0, or -1 if they cannot be read
+
+   char buf[1 << 16];
+   unsigned long long done = 0;
+   ssize_t got;
+
+   *hash = 14695981039346656037ULL;
+   while ( done < length )
+   {
+      got = pread( fileno( out ), buf, (size_t) ( length - done < sizeof( buf ) ? length - done : sizeof( buf ) ),
+                   (off_t) ( offset + done ) );
+      if ( got <= 0 )
+         return -1;
+      *hash = hashMore( *hash, buf, (size_t) got );
+      done += (unsigned long long) got;
+   }
+   return 0;
+}
+
+static int correctManifest ( const struct lineContext *ctx, const char *text, const size_t textLen, const int numThreads,
+                             const char *outPath, const char *manifestPath, const unsigned long long fingerprint,
+                             const _Bool resume, long int *corrWrdCt, long int *return_code )
+{
+   /* function to correct text into outPath block by block, keeping the manifest at manifestPath, as described
+      above.  Returns 0, -2 if a file could not be written, -4 if memory ran out or -7 if the threads could not
+      be started. */
+
+   char partOut[PATH_MAX], partManifest[PATH_MAX], newManifest[PATH_MAX];
+   struct manifestBlock *old = NULL, *kept = NULL, *found, b;
+   long int numOld, numKept = 0, k;
+   const char *oldOut = NULL, *keptOut;
+   size_t oldOutSize = 0, keptOutSize;
+   size_t start = 0, end;
+   long int blockCode;
+   FILE *out = NULL, *manifest = NULL;
+   int rc = 0;
+
+   if ( snprintf( partOut, sizeof( partOut ), "%s.part", outPath ) >= (int) sizeof( partOut )
+        || snprintf( partManifest, sizeof( partManifest ), "%s.part", manifestPath ) >= (int) sizeof( partManifest )
+        || snprintf( newManifest, sizeof( newManifest ), "%s.part.new", manifestPath ) >= (int) sizeof( newManifest ) )
+      return -2;
+   if ( ( numOld = manifestRead( manifestPath, fingerprint, &old ) ) < 0
+        || ( resume && ( numKept = manifestRead( partManifest, fingerprint, &kept ) ) < 0 ) )
+   {
+      free( old );
+      return -4;
+   }
+   if ( numOld > 0 && ( oldOut = mapOutput( outPath, &oldOutSize ) ) == NULL )
+      numOld = 0;                                            // the output it describes is gone
+   qsort( old, (size_t) numOld, sizeof( *old ), compareBlocks );
+
+   keptOut = numKept > 0 ? mapOutput( partOut, &keptOutSize ) : NULL;
+   for ( k = 0; k < numKept; k++ )                           // the blocks of the interrupted run still good
+   {
+      b = kept[k];
+      if ( b.inOffset != start || b.inOffset + b.inLength > textLen
+           || b.inHash != hashMore( 14695981039346656037ULL, text + b.inOffset, b.inLength )
+           || keptOut == NULL || b.outOffset + b.outLength > keptOutSize
+           || b.outHash != hashMore( 14695981039346656037ULL, keptOut + b.outOffset, b.outLength ) )
+         break;
+      start = b.inOffset + b.inLength;
+   }
+   numKept = k;
+   if ( keptOut )
+      munmap( (void *) keptOut, keptOutSize );
+   if ( ( out = fopen( partOut, numKept > 0 ? "r+" : "w+" ) ) == NULL
+        || ( numKept > 0 && ( ftruncate( fileno( out ), (off_t) ( kept[numKept - 1].outOffset + kept[numKept - 1].outLength ) ) != 0
+                              || fseeko( out, 0, SEEK_END ) != 0 ) )
+        || ( manifest = fopen( newManifest, "w" ) ) == NULL
+        || fprintf( manifest, "%s %d %llx\n", MANIFEST_MAGIC, MANIFEST_VERSION, fingerprint ) < 0 )
+      rc = -2;
+   for ( k = 0; k < numKept && rc == 0; k++ )
+   {
+      *corrWrdCt += kept[k].corrections;
+      if ( kept[k].returnCode < 0 )
+         *return_code = kept[k].returnCode;
+      if ( fprintf( manifest, "%llu %llu %llx %llu %llu %llx %ld %ld\n", kept[k].inOffset, kept[k].inLength,
+                    kept[k].inHash, kept[k].outOffset, kept[k].outLength, kept[k].outHash, kept[k].corrections,
+                    kept[k].returnCode ) < 0 )
+         rc = -2;
+   }
+   // the header and the kept blocks reach the disk before they replace file.part, which is never left without them
+   if ( rc == 0 && ( fflush( manifest ) != 0 || fsync( fileno( manifest ) ) != 0 || rename( newManifest, partManifest ) != 0 ) )
+      rc = -2;
+   if ( numKept > 0 && rc == 0 )
+      fprintf (stderr, "resuming at byte %zu of the text\n", start);
+
+   for ( ; start < textLen && rc == 0; start = end )
+   {
+      end = manifestCut( text, textLen, start );
+      b.inOffset = start;
+      b.inLength = end - start;
+      b.inHash = hashMore( 14695981039346656037ULL, text + start, end - start );
+      b.outOffset = (unsigned long long) ftello( out );
+      found = numOld > 0 ? bsearch( &b, old, (size_t) numOld, sizeof( *old ), compareBlocks ) : NULL;
+      if ( found && found->outOffset + found->outLength <= oldOutSize
+           && found->outHash == hashMore( 14695981039346656037ULL, oldOut + found->outOffset, found->outLength ) )
+      {
+         fwrite( oldOut + found->outOffset, 1, found->outLength, out );   // the same text as last time
+         b.outHash = found->outHash;
+         b.corrections = found->corrections;
+         b.returnCode = found->returnCode;
+      }
+      else
+      {
+         found = NULL;
+         b.corrections = 0;
+         blockCode = 1;
+         if ( numThreads > 1 )
+            rc = correctParallel( ctx, text + start, end - start, numThreads, out, &b.corrections, &blockCode ) ? -7 : 0;
+         else
+            correctText( ctx, text + start, end - start, out, &b.corrections, &blockCode );
+         b.returnCode = blockCode;
+      }
+      if ( fflush( out ) != 0 )
+         rc = -2;
+      b.outLength = (unsigned long long) ftello( out ) - b.outOffset;
+      if ( found == NULL && rc == 0 && hashWritten( out, b.outOffset, b.outLength, &b.outHash ) != 0 )
+         rc = -2;
+      *corrWrdCt += b.corrections;
+      if ( b.returnCode < 0 )
+         *return_code = b.returnCode;
+      if ( rc == 0 && ( fprintf( manifest, "%llu %llu %llx %llu %llu %llx %ld %ld\n", b.inOffset, b.inLength, b.inHash,
+                                 b.outOffset, b.outLength, b.outHash, b.corrections, b.returnCode ) < 0
+                        || fflush( manifest ) != 0 ) )
+         rc = -2;
+   }
+   if ( out && fclose( out ) != 0 )
+      rc = -2;
+   if ( manifest && fclose( manifest ) != 0 )
+      rc = -2;
+   if ( oldOut )
+      munmap( (void *) oldOut, oldOutSize );
+   free( old );
+   free( kept );
+   if ( rc == 0 && ( rename( partOut, outPath ) != 0 || rename( partManifest, manifestPath ) != 0 ) )
+      rc = -2;
+   return rc;
+}
+
+#endif /* AUTOSPELL_NO_MAIN */
+
+/***************************** the library ******************************/
+
+/* The functions declared in autospell.h, which the program is itself built on: main opens the dictionary with
+   autospell_open and corrects the text with the lineContext of the handle.  A handle is only read once it is open
+   (the cache has its own lock), so any number of threads may correct with it at the same time. */
+
+struct autospell_dict
+{
+   struct dictionary dict;                 // the dictionary words (or the image's, mapped)
+   long int wordLenIndex[MAXL + 2];        // where the words of each length start (wordLenIndex[0] is numWords)
+   size_t lastWordSize;                    // length of the longest dictionary word
+   unsigned long long dictHash;            // hash of all the dictionary words
+   unsigned long long fingerprint;         // hash of the settings and dictionary that a cache or manifest must match
+   struct searchIndex index;               // options index and kernel and what they build from the dictionary
+   void *image;                            // the mapped dictionary image, if the dictionary is one
+   size_t imageSize;
+   _Bool indexMapped;                      // the BK-tree, symmetric-delete, hole index or DAWG is in the image
+   _Bool exactMapped;                      // the exact word table is in the image
+   double indexSeconds;                    // spent in buildIndex on what the image did not hold (for --stats)
+   struct correctionCache cache;           // option cache, if ctx.cache is not NULL
+   unsigned char delimTable[256];
+   struct lineContext ctx;                 // what correctLine needs, pointing into the above
+};
+
+/***************************** function autospell_close ******************************/
+
+int autospell_close ( autospell_dict *d )
+{
+   // function to save the cache of d and free all of d; returns 0 or AUTOSPELL_EFILE if the cache was not written
+
+   int k, rc = 0;
+
+   if ( d == NULL )
+      return 0;
+   if ( d->ctx.cache )
+   {
+      if ( cacheSave( &d->cache ) != 0 )
+      {
+         fprintf (stderr, "cannot write the cache file %s\n", d->cache.path);
+         rc = AUTOSPELL_EFILE;
+      }
+      cacheClose( &d->cache );
+   }
+   if ( d->image != NULL )
+      munmap( d->image, d->imageSize );
+   else
+   {
+      free( d->dict.arena );
+      free( d->dict.offset );
+      free( d->dict.freq );
+   }
+   for ( k = 0; k <= MAXL; k++ )
+      free( d->index.transposed[k].chars );
+   if ( !d->indexMapped )
+   {
+      free( d->index.bkTree );
+      free( d->index.sym.slots );
+      free( d->index.sym.posting );
+      free( d->index.hole.slots );
+      free( d->index.hole.posting );
+      free( d->index.dawg );
+      free( d->index.dawgWord );
+   }
+   if ( !d->exactMapped )
+      free( d->index.exact.slots );
+   free( d->index.trie );
+   free( d->index.confusions );
+   free( d );
+   return rc;
+}
+
+/***************************** function autospell_open ******************************/
+
+static int openImage ( autospell_dict *d )
+{
+   /* function to take the words, their length index and, if it holds the one wanted, the index of d from the
+      mapped dictionary image d->image */
+
+   const struct dictImageHeader *header = d->image;
+   struct searchIndex *index = &d->index;
+   int k;
+
+   d->dict.arena = (char *) d->image + header->offset[SECTION_WORDS];
+   d->dict.offset = (unsigned int *) ( (char *) d->image + header->offset[SECTION_OFFSETS] );
+   d->dict.numWords = (long int) header->numWords;
+   d->lastWordSize = (size_t) header->lastWordSize;
+   d->dictHash = header->dictHash;
+   for ( k = 0; k <= MAXL + 1; k++ )
+      d->wordLenIndex[k] = (long int) header->wordLenIndex[k];
+   for ( k = 0; k < (int) header->numWide && k < NARROW_OTHER - NARROW_FIRST; k++ )
+      (void) narrowAdd( &d->dict, header->wide[k] );
+   if ( header->size[SECTION_EXACT] == ( header->exactMask + 1 ) * sizeof( *index->exact.slots ) )
+   {
+      index->exact.slots = (unsigned int *) ( (char *) d->image + header->offset[SECTION_EXACT] );
+      index->exact.mask = (unsigned long int) header->exactMask;
+      d->exactMapped = (_Bool) 1;
+   }
+   if ( header->size[SECTION_FREQ] == header->numWords * sizeof( *d->dict.freq ) && header->numWords > 0 )
+      d->dict.freq = (unsigned int *) ( (char *) d->image + header->offset[SECTION_FREQ] );
+   if ( index->mode == INDEX_BK && header->size[SECTION_BK] == header->numWords * sizeof( *index->bkTree ) )
+   {
+      index->bkTree = (struct bkNode *) ( (char *) d->image + header->offset[SECTION_BK] );
+      d->indexMapped = (_Bool) 1;
+   }
+   else if ( index->mode == INDEX_SYM && header->size[SECTION_SYM_SLOTS] == ( header->symMask + 1 ) * sizeof( *index->sym.slots ) )
+   {
+      index->sym.slots = (struct symSlot *) ( (char *) d->image + header->offset[SECTION_SYM_SLOTS] );
+      index->sym.mask = (unsigned long int) header->symMask;
+      index->sym.posting = (unsigned int *) ( (char *) d->image + header->offset[SECTION_SYM_POSTING] );
+      index->sym.numPostings = (unsigned long int) ( header->size[SECTION_SYM_POSTING] / sizeof( *index->sym.posting ) );
+      d->indexMapped = (_Bool) 1;
+   }
+   else if ( index->mode == INDEX_HOLE && header->size[SECTION_HOLE_SLOTS] == ( header->holeMask + 1 ) * sizeof( *index->hole.slots ) )
+   {
+      index->hole.slots = (struct symSlot *) ( (char *) d->image + header->offset[SECTION_HOLE_SLOTS] );
+      index->hole.mask = (unsigned long int) header->holeMask;
+      index->hole.posting = (unsigned int *) ( (char *) d->image + header->offset[SECTION_HOLE_POSTING] );
+      index->hole.numPostings = (unsigned long int) ( header->size[SECTION_HOLE_POSTING] / sizeof( *index->hole.posting ) );
+      d->indexMapped = (_Bool) 1;
+   }
+   else if ( index->mode == INDEX_DAWG && header->size[SECTION_DAWG] > 0 )
+   {
+      index->dawg = (struct dawgNode *) ( (char *) d->image + header->offset[SECTION_DAWG] );
+      index->dawgNodes = (unsigned long int) ( header->size[SECTION_DAWG] / sizeof( *index->dawg ) );
+      index->dawgRoot = (unsigned int) header->dawgRoot;
+      index->dawgWord = (unsigned int *) ( (char *) d->image + header->offset[SECTION_DAWG_WORDS] );
+      index->dawgWords = (unsigned long int) ( header->size[SECTION_DAWG_WORDS] / sizeof( *index->dawgWord ) );
+      d->indexMapped = (_Bool) 1;
+   }
+   return 0;
+}
+
+static int buildIndex ( autospell_dict *d )
+{
+   // function to build what the options of d ask for and the image did not hold; returns 0 or AUTOSPELL_ENOMEM
+
+   struct searchIndex *index = &d->index;
+   struct timespec t0, t1;
+
+   clock_gettime( CLOCK_MONOTONIC, &t0 );
+   if ( index->exact.slots == NULL && exactBuild( &index->exact, &d->dict ) != 0 )
+   {
+      fprintf (stderr, "cannot allocate the exact word table\n");
+      return AUTOSPELL_ENOMEM;
+   }
+   if ( index->kernel == KERNEL_SIMD )
+   {
+      if ( ( index->levBlock = pickLevBlock() ) == NULL || index->mode != INDEX_SCAN )
+         index->kernel = KERNEL_BIT;                         // the SIMD kernels only serve the bucket scan
+      else if ( transposeBuild( index->transposed, &d->dict, d->wordLenIndex ) != 0 )
+      {
+         fprintf (stderr, "cannot allocate the transposed dictionary buckets\n");
+         return AUTOSPELL_ENOMEM;
+      }
+   }
+   if ( index->mode == INDEX_BK && index->bkTree == NULL )
+   {
+      if ( ( index->bkTree = malloc( d->dict.numWords * sizeof( *index->bkTree ) ) ) == NULL )
+      {
+         fprintf (stderr, "cannot allocate the BK-tree\n");
+         return AUTOSPELL_ENOMEM;
+      }
+      bkBuild( index->bkTree, &d->dict, d->wordLenIndex, index );
+   }
+   else if ( index->mode == INDEX_SYM && index->sym.slots == NULL && symBuild( &index->sym, &d->dict, d->wordLenIndex ) != 0 )
+   {
+      fprintf (stderr, "cannot allocate the symmetric-delete index\n");
+      return AUTOSPELL_ENOMEM;
+   }
+   else if ( index->mode == INDEX_HOLE && index->hole.slots == NULL && holeBuild( &index->hole, &d->dict ) != 0 )
+   {
+      fprintf (stderr, "cannot allocate the hole index\n");
+      return AUTOSPELL_ENOMEM;
+   }
+   else if ( index->mode == INDEX_DAWG && index->dawg == NULL && dawgBuild( index, &d->dict ) != 0 )
+   {
+      fprintf (stderr, "cannot allocate the DAWG\n");
+      return AUTOSPELL_ENOMEM;
+   }
+   else if ( index->mode == INDEX_TRIE && ( index->trieNodes = trieBuild( &index->trie, &d->dict ) ) < 0 )
+   {
+      fprintf (stderr, "cannot allocate the trie\n");
+      return AUTOSPELL_ENOMEM;
+   }
+   clock_gettime( CLOCK_MONOTONIC, &t1 );
+   d->indexSeconds = (double) ( t1.tv_sec - t0.tv_sec ) + (double) ( t1.tv_nsec - t0.tv_nsec ) / 1e9;
+   return 0;
+}
+
+int autospell_open ( const char *path, const struct autospell_options *options, autospell_dict **dict )
+{
+   /* function to read (or map) the dictionary at path and build its index as options ask, into a new handle *dict.
+      Returns 0, or AUTOSPELL_EUSAGE, AUTOSPELL_EDICT or AUTOSPELL_ENOMEM and *dict is NULL. */
+
+   static const struct autospell_options defaults = { NULL, NULL, NULL, NULL, NULL };
+   autospell_dict *d;
+   struct searchIndex *index;
+   FILE *wordList;
+   unsigned long long fingerprint;         // hash of the settings and dictionary that the cache must match
+   int maxED;                              // the maxED tier of each word length, as part of the fingerprint
+   long int rc = 0;
+   int k;
+   char delimiters[] = DELIMITERS;
+
+   *dict = NULL;
+   if ( options == NULL )
+      options = &defaults;
+   if ( ( d = calloc( 1, sizeof( *d ) ) ) == NULL )
+      return AUTOSPELL_ENOMEM;
+   index = &d->index;
+   index->matcher = MATCHER_LEV;
+   index->mode = INDEX_BK;
+   index->kernel = KERNEL_BIT;
+   if ( options->matcher == NULL || strcmp( options->matcher, "lev" ) == 0 )
+      index->matcher = MATCHER_LEV;
+   else if ( strcmp( options->matcher, "sim" ) == 0 )
+      index->matcher = MATCHER_SIM;
+   else if ( strcmp( options->matcher, "ocr" ) == 0 )
+      index->matcher = MATCHER_OCR;
+   else
+      rc = AUTOSPELL_EUSAGE;
+   if ( options->index == NULL || strcmp( options->index, "bk" ) == 0 )
+      index->mode = INDEX_BK;
+   else if ( strcmp( options->index, "sym" ) == 0 )
+      index->mode = INDEX_SYM;
+   else if ( strcmp( options->index, "scan" ) == 0 )
+      index->mode = INDEX_SCAN;
+   else if ( strcmp( options->index, "hole" ) == 0 )
+      index->mode = INDEX_HOLE;
+   else if ( strcmp( options->index, "dawg" ) == 0 )
+      index->mode = INDEX_DAWG;
+   else
+      rc = AUTOSPELL_EUSAGE;
+   if ( options->kernel == NULL || strcmp( options->kernel, "bit" ) == 0 )
+      index->kernel = KERNEL_BIT;
+   else if ( strcmp( options->kernel, "dp" ) == 0 )
+      index->kernel = KERNEL_DP;
+   else if ( strcmp( options->kernel, "simd" ) == 0 )
+      index->kernel = KERNEL_SIMD;
+   else
+      rc = AUTOSPELL_EUSAGE;
+   if ( rc == AUTOSPELL_EUSAGE )
+   {
+      free( d );
+      return AUTOSPELL_EUSAGE;
+   }
+   if ( index->matcher == MATCHER_SIM )
+   {
+      d->ctx.minCharWord = 9;
+      if ( index->mode != INDEX_SCAN )
+         index->mode = INDEX_HOLE;         // the one index of the sim matcher
+      index->kernel = KERNEL_BIT;
+   }
+   else if ( index->matcher == MATCHER_OCR )
+   {
+      d->ctx.minCharWord = 7;
+      index->mode = INDEX_TRIE;            // the one index of the ocr matcher
+      index->kernel = KERNEL_BIT;
+   }
+   else
+   {
+      d->ctx.minCharWord = 7;
+      if ( index->mode == INDEX_HOLE )
+         index->mode = INDEX_BK;
+   }
+
+   d->dictHash = 14695981039346656037ULL;
+   if ( ( rc = mapDictImage( path, &d->image, &d->imageSize ) ) < 0 )
+   {
+      d->image = NULL;
+      autospell_close( d );
+      return AUTOSPELL_EDICT;
+   }
+   if ( rc == 0 )                          // a compiled image: use its words (and index if it has the one wanted)
+      openImage( d );
+   else
+   {
+      d->image = NULL;
+      if ( ( wordList = fopen( path, "r" ) ) == NULL )
+      {
+         fprintf (stderr, "cannot read the input dictionary %s\n", path);
+         autospell_close( d );
+         return AUTOSPELL_EDICT;
+      }
+      rc = readWordList( wordList, &d->dict, d->wordLenIndex, &d->lastWordSize, &d->dictHash );
+      (void) fclose( wordList );
+      if ( rc != 0 )
+      {
+         if ( rc == -3 )
+            fprintf (stderr, "the input dictionary has more than %d different non-ASCII characters\n",
+                     NARROW_OTHER - NARROW_FIRST);
+         else
+            fprintf (stderr, rc == -1 ? "the input dictionary is not properly sorted\n"
+                                      : "cannot allocate memory for the dictionary\n");
+         autospell_close( d );
+         return rc == -2 ? AUTOSPELL_ENOMEM : AUTOSPELL_EDICT;
+      }
+   }
+   if ( index->matcher == MATCHER_OCR )
+   {
+      if ( ( index->confusions = malloc( sizeof( *index->confusions ) ) ) == NULL )
+      {
+         autospell_close( d );
+         return AUTOSPELL_ENOMEM;
+      }
+      if ( ocrTableLoad( index->confusions, &d->dict, options->confusions ) != 0 )
+      {
+         autospell_close( d );
+         return AUTOSPELL_EUSAGE;
+      }
+   }
+   if ( ( rc = buildIndex( d ) ) != 0 )
+   {
+      autospell_close( d );
+      return (int) rc;
+   }
+   fingerprint = hashMore( d->dictHash, index->matcher == MATCHER_SIM ? "autoSpellSim"
+                                        : index->matcher == MATCHER_OCR ? "autoSpellOcr" : "autoSpellLev",
+                           sizeof( "autoSpellSim" ) );
+   if ( index->matcher == MATCHER_OCR )
+      fingerprint = hashMore( fingerprint, (const char *) index->confusions, sizeof( *index->confusions ) );
+   fingerprint = hashMore( fingerprint, (const char *) &d->ctx.minCharWord, sizeof( d->ctx.minCharWord ) );
+   for ( k = 0; index->matcher == MATCHER_LEV && k <= MAXL; k++ )
+   {
+      maxED = maxEdits( k );
+      fingerprint = hashMore( fingerprint, (const char *) &maxED, sizeof( maxED ) );
+   }
+   d->fingerprint = fingerprint;
+   if ( options->cache )
+   {
+      cacheOpen( &d->cache, options->cache, fingerprint );
+      d->ctx.cache = &d->cache;
+   }
+
+   makeDelimTable( d->delimTable, delimiters );
+   d->ctx.delimTable = d->delimTable;
+   d->ctx.lastWordSize = d->lastWordSize;
+   d->ctx.dict = &d->dict;
+   d->ctx.wordLenIndex = d->wordLenIndex;
+   d->ctx.index = index;
+   *dict = d;
+   return 0;
+}
+
+/***************************** function autospell_correct_word ******************************/
+
+static int correctWord ( const struct lineContext *ctx, const char *word, const size_t length, char *out,
+                         long int *corrWrdCt )
+{
+   /* function to copy to out (room for MAXB + 1) the word of length bytes, corrected as correctLine corrects a
+      word of a text.  Returns 1 if it was corrected, 0 if not, or -6 (and out is empty) if it is longer than MAXL
+      characters. */
+
+   long int before = *corrWrdCt;
+   size_t chars = charCount( word, length );
+
+   threadStats.words++;
+   out[0] = '\0';
+   if ( chars > MAXL )
+   {
+      threadStats.longWords++;
+      return -6;
+   }
+   if ( chars < ctx->minCharWord || chars > ctx->lastWordSize )
+   {
+      if ( chars < ctx->minCharWord )
+         threadStats.shortWords++;
+      else
+         threadStats.longWords++;
+      memcpy( out, word, length );
+      out[length] = '\0';
+      return 0;
+   }
+   (void) returnWord( out, word, (int) length, ctx->dict, ctx->wordLenIndex, ctx->index, ctx->cache, corrWrdCt );
+   return *corrWrdCt > before;
+}
+
+int autospell_correct_word ( const autospell_dict *d, const char *word, size_t length, char out[AUTOSPELL_MAXB + 1] )
+{
+   // function to copy to out word corrected with the dictionary d (see autospell.h)
+
+   long int corrWrdCt = 0;
+
+   return correctWord( &d->ctx, word, length, out, &corrWrdCt );
+}
+
+long int autospell_correct_words ( const autospell_dict *d, const struct autospell_span words[], size_t n,
+                                   struct autospell_word out[] )
+{
+   // function to correct each of the n words with the dictionary d; returns the number corrected
+
+   long int corrWrdCt = 0;
+   size_t k;
+
+   for ( k = 0; k < n; k++ )
+      out[k].status = correctWord( &d->ctx, words[k].text, words[k].length, out[k].text, &corrWrdCt );
+   return corrWrdCt;
+}
+
+/***************************** function autospell_correct_buffer ******************************/
+
+long int autospell_correct_buffer ( const autospell_dict *d, const char *text, size_t textLen, char *out,
+                                    size_t outSize, size_t *outLen )
+{
+   /* function to correct text into out with the dictionary d (see autospell.h).  The text is corrected into
+      memory as correctParallel corrects a chunk and then copied to out if it fits. */
+
+   FILE *outFile;
+   char *buf;
+   size_t bufLen;
+   long int corrWrdCt = 0, return_code = 1;
+
+   *outLen = 0;
+   if ( ( outFile = open_memstream( &buf, &bufLen ) ) == NULL )
+      return AUTOSPELL_ENOMEM;
+   correctText( &d->ctx, text, textLen, outFile, &corrWrdCt, &return_code );
+   if ( fclose( outFile ) != 0 )
+   {
+      free( buf );
+      return AUTOSPELL_ENOMEM;
+   }
+   *outLen = bufLen;
+   if ( bufLen > outSize )
+      return_code = AUTOSPELL_ESPACE;
+   else
+      memcpy( out, buf, bufLen );
+   free( buf );
+   return return_code < 0 ? return_code : corrWrdCt;
+}
+
+/***************************** function readWhole ******************************/
+
+#ifndef AUTOSPELL_NO_MAIN                  // the rest of the file is the program: bench/ includes it for the above
+
+static char *readWhole ( FILE *f, size_t *size )
+{
+   // function to read all of f into a malloc-ed buffer; NULL if memory ran out
+
+   char *buf = NULL, *grown;
+   size_t max = 0, got;
+
+   *size = 0;
+   do
+   {
+      if ( *size == max )
+      {
+         max = max ? 2 * max : 1 << 20;
+         if ( ( grown = realloc( buf, max ) ) == NULL )
+         {
+            free( buf );
+            return NULL;
+         }
+         buf = grown;
+      }
+      got = fread( buf + *size, 1, max - *size, f );
+      *size += got;
+   } while ( got > 0 );
+   return buf;
+}
+
+/***************************** the daemon ******************************/
+
+/* "autoSpell serve dictionary socket" reads the dictionary and builds its index once, then corrects the texts sent
+   to it over the Unix domain socket socket, so a page costs only its correction.  -j N threads (by default one for
+   each processor) each serve one connection at a time, from when it is accepted until the client closes it; while
+   all of them are busy more clients wait to be accepted.  A connection may send any number of requests one after
+   the other, but one that sends nothing (or takes no reply) for DAEMON_IDLE_SECONDS is closed by the daemon, so a
+   client that keeps its connection open between pages holds a thread for no longer than that.
+   "autoSpell client socket text_file" sends one request and prints the reply.
+
+   request:   struct daemonRequest, then length bytes
+              kind DAEMON_TEXT:  a text, corrected as autoSpell corrects a text file
+              kind DAEMON_WORDS: a word list, one word a line, each corrected as a whole word (minCharWord and the
+                                 other limits still apply) and answered one word a line in the same order
+   reply:     struct daemonReply, then length bytes of the corrected text or words
+
+   The numbers are in network byte order.  status is 1 or -5 / -6 as the return code of autoSpell would be for the
+   text, or -8 if the request was of an unknown kind or longer than DAEMON_MAX_REQUEST; the daemon then closes
+   the connection. */
+
+#define DAEMON_TEXT 'T'
+#define DAEMON_WORDS 'W'
+#define DAEMON_MAX_REQUEST ( 64 << 20 )
+#define DAEMON_IDLE_SECONDS 10            // a connection quiet for this long is closed
+
+struct daemonRequest
+{
+   unsigned char kind;            // DAEMON_TEXT or DAEMON_WORDS
+   unsigned char pad[3];
+   unsigned int length;           // bytes that follow
+};
+
+struct daemonReply
+{
+   unsigned int length;           // bytes that follow
+   unsigned int corrections;      // words corrected in this request
+   int status;
+};
+
+struct daemonPool                 // shared by the threads of serveDaemon
+{
+   const struct lineContext *ctx;
+   int listenFd;
+};
+
+/***************************** functions readFull and writeFull ******************************/
+
+static int readFull ( const int fd, void *buf, size_t n )
+{
+   // function to read exactly n bytes from fd; returns 0, or -1 at the end of the connection or on an error
+
+   ssize_t got;
+
+   while ( n > 0 )
+   {
+      if ( ( got = read( fd, buf, n ) ) <= 0 )
+      {
+         if ( got < 0 && errno == EINTR )
+            continue;
+         return -1;
+      }
+      buf = (char *) buf + got;
+      n -= (size_t) got;
+   }
+   return 0;
+}
+
+static int writeFull ( const int fd, const void *buf, size_t n )
+{
+   // function to write all n bytes of buf to fd (without SIGPIPE if the peer went away); returns 0 or -1
+
+   ssize_t put;
+
+   while ( n > 0 )
+   {
+      if ( ( put = send( fd, buf, n, MSG_NOSIGNAL ) ) < 0 )
+      {
+         if ( errno == EINTR )
+            continue;
+         return -1;
+      }
+      buf = (const char *) buf + put;
+      n -= (size_t) put;
+   }
+   return 0;
+}
+
+/***************************** function correctWords ******************************/
+
+static void correctWords ( const struct lineContext *ctx, const char *words, const size_t wordsLen, FILE *out,
+                           long int *corrWrdCt )
+{
+   // function to print to out each line of words corrected as a single word, one a line (a DAEMON_WORDS request)
+
+   const char *word, *end;
+   char simOrSame[MAXB + 1];
+   size_t len;
+
+   for ( word = words; word < words + wordsLen; word = end + 1 )
+   {
+      if ( ( end = memchr( word, '\n', (size_t) ( words + wordsLen - word ) ) ) == NULL )
+         end = words + wordsLen;
+      len = (size_t) ( end - word );
+      if ( len > 0 && word[len - 1] == '\r' )
+         len--;
+      if ( correctWord( ctx, word, len, simOrSame, corrWrdCt ) < 0 )
+         fwrite( word, 1, len, out );      // longer than MAXL: as it is
+      else
+         fputs( simOrSame, out );
+      putc( '\n', out );
+   }
+}
+
+/***************************** function serveConnection ******************************/
+
+static void serveConnection ( const struct lineContext *ctx, const int fd )
+{
+   // function to answer the requests that come on the connection fd until the client closes it
+
+   struct daemonRequest request;
+   struct daemonReply reply;
+   char *in, *out;
+   size_t outLen;
+   long int corrWrdCt, return_code;
+   FILE *outFile;
+
+   while ( readFull( fd, &request, sizeof( request ) ) == 0 )
+   {
+      request.length = ntohl( request.length );
+      if ( ( request.kind != DAEMON_TEXT && request.kind != DAEMON_WORDS ) || request.length > DAEMON_MAX_REQUEST
+           || ( in = malloc( request.length + 1 ) ) == NULL )
+      {
+         reply.length = reply.corrections = 0;
+         reply.status = (int) htonl( (unsigned int) -8 );
+         (void) writeFull( fd, &reply, sizeof( reply ) );
+         return;
+      }
+      if ( readFull( fd, in, request.length ) != 0 || ( outFile = open_memstream( &out, &outLen ) ) == NULL )
+      {
+         free( in );
+         return;
+      }
+      corrWrdCt = 0;
+      return_code = 1;
+      if ( request.kind == DAEMON_TEXT )
+         correctText( ctx, in, request.length, outFile, &corrWrdCt, &return_code );
+      else
+         correctWords( ctx, in, request.length, outFile, &corrWrdCt );
+      free( in );
+      if ( fclose( outFile ) != 0 )
+         return;
+      reply.length = htonl( (unsigned int) outLen );
+      reply.corrections = htonl( (unsigned int) corrWrdCt );
+      reply.status = (int) htonl( (unsigned int) return_code );
+      if ( writeFull( fd, &reply, sizeof( reply ) ) != 0 || writeFull( fd, out, outLen ) != 0 )
+      {
+         free( out );
+         return;
+      }
+      free( out );
+   }
+}
+
+/***************************** function serveDaemon ******************************/
+
+static void *daemonWorker ( void *arg )
+{
+   // function run by each thread of the daemon: accept a connection, serve it, repeat
+
+   struct daemonPool *pool = arg;
+   const struct timeval idle = { DAEMON_IDLE_SECONDS, 0 };
+   int fd;
+
+   while ( 1 )
+   {
+      if ( ( fd = accept( pool->listenFd, NULL, NULL ) ) < 0 )
+      {
+         if ( errno == EINTR || errno == ECONNABORTED )
+            continue;
+         return NULL;                      // the socket was shut down
+      }
+      // readFull and writeFull fail once the client has been quiet for DAEMON_IDLE_SECONDS, which ends the connection
+      setsockopt( fd, SOL_SOCKET, SO_RCVTIMEO, &idle, sizeof( idle ) );
+      setsockopt( fd, SOL_SOCKET, SO_SNDTIMEO, &idle, sizeof( idle ) );
+      serveConnection( pool->ctx, fd );
+      close( fd );
+   }
+}
+
+static int serveDaemon ( const struct lineContext *ctx, const char *socketPath, const int numThreads )
+{
+   /* function to listen on the Unix domain socket socketPath (replacing a socket left there by an earlier daemon)
+      and serve it with numThreads threads until SIGINT or SIGTERM.  The socket is removed again on the way out,
+      but the threads are not waited for: the caller should save what it must and exit.
+      Returns 0 after a signal, -8 if the socket could not be made, -7 if no thread could be started. */
+
+   struct sockaddr_un addr;
+   struct daemonPool pool;
+   struct stat st;
+   sigset_t signals;
+   pthread_t thread;
+   int t, sig, started = 0;
+
+   if ( strlen( socketPath ) >= sizeof( addr.sun_path ) )
+   {
+      fprintf (stderr, "the socket path %s is too long\n", socketPath);
+      return -8;
+   }
+   memset( &addr, 0, sizeof( addr ) );
+   addr.sun_family = AF_UNIX;
+   strcpy( addr.sun_path, socketPath );
+   if ( lstat( socketPath, &st ) == 0 && S_ISSOCK( st.st_mode ) )
+      unlink( socketPath );
+   if ( ( pool.listenFd = socket( AF_UNIX, SOCK_STREAM, 0 ) ) < 0
+        || bind( pool.listenFd, (struct sockaddr *) &addr, sizeof( addr ) ) != 0 || listen( pool.listenFd, 64 ) != 0 )
+   {
+      fprintf (stderr, "cannot listen on the socket %s\n", socketPath);
+      if ( pool.listenFd >= 0 )
+         close( pool.listenFd );
+      return -8;
+   }
+   pool.ctx = ctx;
+
+   sigemptyset( &signals );                // the threads inherit the mask: only sigwait below takes the signals
+   sigaddset( &signals, SIGINT );
+   sigaddset( &signals, SIGTERM );
+   pthread_sigmask( SIG_BLOCK, &signals, NULL );
+   for ( t = 0; t < numThreads; t++ )
+      if ( pthread_create( &thread, NULL, daemonWorker, &pool ) == 0 )
+      {
+         pthread_detach( thread );
+         started++;
+      }
+   if ( started > 0 )
+   {
+      fprintf (stderr, "serving on %s with %d threads\n", socketPath, started);
+      while ( sigwait( &signals, &sig ) != 0 )
+         ;
+   }
+   shutdown( pool.listenFd, SHUT_RDWR );
+   close( pool.listenFd );
+   unlink( socketPath );
+   return started > 0 ? 0 : -7;
+}
+
+/***************************** function runClient ******************************/
+
+static long int runClient ( const char *socketPath, const char *textPath, const unsigned char kind )
+{
+   /* function for "autoSpell client": send the text (or word list) textPath (- for standard input) to the daemon
+      listening on socketPath and print the reply.  Returns what autoSpell itself would: the number of corrections,
+      or -5 / -6 from the daemon, -2 if the text cannot be read, -4 if memory ran out and -8 if the daemon cannot be
+      reached or refused the request. */
+
+   struct sockaddr_un addr;
+   struct daemonRequest request;
+   struct daemonReply reply;
+   FILE *textFile;
+   char *text, *out;
+   size_t textLen;
+   int fd;
+
+   if ( strcmp( textPath, "-" ) == 0 )
+      textFile = stdin;
+   else if ( ( textFile = fopen( textPath, "r" ) ) == NULL )
+   {
+      fprintf (stderr, "cannot read the input text file %s\n", textPath);
+      return -2;
+   }
+   text = readWhole( textFile, &textLen );
+   if ( textFile != stdin )
+      fclose( textFile );
+   if ( text == NULL )
+   {
+      fprintf (stderr, "cannot allocate memory for the text\n");
+      return -4;
+   }
+   if ( textLen > DAEMON_MAX_REQUEST || strlen( socketPath ) >= sizeof( addr.sun_path ) )
+   {
+      fprintf (stderr, "the text is too long for one request or the socket path is too long\n");
+      free( text );
+      return -8;
+   }
+   memset( &addr, 0, sizeof( addr ) );
+   addr.sun_family = AF_UNIX;
+   strcpy( addr.sun_path, socketPath );
+   memset( &request, 0, sizeof( request ) );
+   request.kind = kind;
+   request.length = htonl( (unsigned int) textLen );
+   if ( ( fd = socket( AF_UNIX, SOCK_STREAM, 0 ) ) < 0 || connect( fd, (struct sockaddr *) &addr, sizeof( addr ) ) != 0
+        || writeFull( fd, &request, sizeof( request ) ) != 0 || writeFull( fd, text, textLen ) != 0
+        || readFull( fd, &reply, sizeof( reply ) ) != 0 )
+   {
+      fprintf (stderr, "cannot reach the daemon at %s\n", socketPath);
+      if ( fd >= 0 )
+         close( fd );
+      free( text );
+      return -8;
+   }
+   free( text );
+   reply.length = ntohl( reply.length );
+   reply.corrections = ntohl( reply.corrections );
+   reply.status = (int) ntohl( (unsigned int) reply.status );
+   if ( reply.status == -8 || ( out = malloc( reply.length + 1 ) ) == NULL || readFull( fd, out, reply.length ) != 0 )
+   {
+      fprintf (stderr, "the daemon at %s refused the request\n", socketPath);
+      close( fd );
+      return -8;
+   }
+   close( fd );
+   fwrite( out, 1, reply.length, stdout );
+   free( out );
+   return reply.status < 0 ? reply.status : (long int) reply.corrections;
+}
+
+/***************************** function printStats ******************************/
+
+enum statsFormat { STATS_NONE, STATS_TEXT, STATS_JSON };
+
+static void printStats ( FILE *out, const enum statsFormat format, const struct runStats *stats,
+                         const struct searchIndex *index, const double indexSeconds, const long int corrWrdCt,
+                         const double loadTime, const double totalTime )
+{
+   /* function to print the --stats report to out, as text or as one JSON object.  The times of tokenize, search
+      and output are added up over the threads, so with -j they may add up to more than the total.  indexSeconds
+      is the part of loadTime spent building the index (0 if the image held it). */
+
+   static const char *simNames[3] = { "none", "similar", "identical" };
+   static const char *modeNames[] = { "scan", "bk", "sym", "hole", "trie", "dawg" };   // as enum indexMode
+   const enum matcher matcher = index->matcher;
+   const struct symIndex *sym = index->mode == INDEX_HOLE ? &index->hole : &index->sym;
+   char indexSize[160] = "";               // the size of the symmetric-delete or hole index or the DAWG
+   long int exact = stats->found[matcher == MATCHER_SIM ? 2 : 0] + stats->members;
+   double perSearch = stats->searches ? (double) stats->comparisons / (double) stats->searches : 0.0;
+   int k, last = matcher == MATCHER_SIM ? 2 : maxEdits( MAXL );
+
+   if ( ( index->mode == INDEX_SYM || index->mode == INDEX_HOLE ) && sym->slots )
+      snprintf( indexSize, sizeof( indexSize ), format == STATS_JSON ? ", \"postings\": %lu, \"slots\": %lu, \"mb\": %.1f"
+                                                                     : "  (%lu postings, %lu slots, %.1f MB)",
+                sym->numPostings, sym->mask + 1, ( (double) sym->numPostings * sizeof( *sym->posting )
+                                                   + (double) ( sym->mask + 1 ) * sizeof( *sym->slots ) ) / ( 1024.0 * 1024.0 ) );
+   else if ( index->mode == INDEX_DAWG && index->dawg )
+      snprintf( indexSize, sizeof( indexSize ), format == STATS_JSON ? ", \"nodes\": %lu, \"words\": %lu, \"mb\": %.1f"
+                                                                     : "  (%lu nodes for %lu words, %.1f MB)",
+                index->dawgNodes - 1, index->dawgWords, ( (double) index->dawgNodes * sizeof( *index->dawg )
+                                                          + (double) index->dawgWords * sizeof( *index->dawgWord ) ) / ( 1024.0 * 1024.0 ) );
+
+   if ( format == STATS_JSON )
+   {
+      fprintf( out, "{ \"matcher\": \"%s\", \"words\": %ld, \"skipped_short\": %ld, \"skipped_long\": %ld, \"calls\": %ld, "
+                    "\"cache_hits\": %ld, \"in_dictionary\": %ld, \"searches\": %ld, \"comparisons\": %ld, \"comparisons_per_search\": %.1f, "
+                    "\"exact\": %ld, \"corrected\": %ld, \"found\": { ",
+               matcher == MATCHER_SIM ? "sim" : matcher == MATCHER_OCR ? "ocr" : "lev", stats->words, stats->shortWords, stats->longWords,
+               stats->calls, stats->cacheHits, stats->members, stats->searches, stats->comparisons, perSearch, exact,
+               corrWrdCt );
+      for ( k = 0; k <= last; k++ )
+         if ( matcher == MATCHER_SIM )
+            fprintf( out, "%s\"%s\": %ld", k ? ", " : "", simNames[k], stats->found[k] );
+         else
+            fprintf( out, "%s\"%d\": %ld", k ? ", " : "", k, stats->found[k] );
+      if ( matcher != MATCHER_SIM )
+         fprintf( out, ", \"none\": %ld", stats->found[MAXL + 1] );
+      fprintf( out, " }, \"index\": { \"mode\": \"%s\", \"seconds\": %.3f%s }, "
+                    "\"seconds\": { \"load\": %.3f, \"tokenize\": %.3f, \"search\": %.3f, \"output\": %.3f, \"total\": %.3f } }\n",
+               modeNames[index->mode], indexSeconds, indexSize, loadTime, stats->tokenizeTime, stats->searchTime,
+               stats->outputTime, totalTime );
+      return;
+   }
+   fprintf( out, "words                 %12ld\n"
+                 "  too short           %12ld   (fewer than minCharWord characters)\n"
+                 "  too long            %12ld   (longer than the longest dictionary word)\n"
+                 "returnWord calls      %12ld\n"
+                 "  from the cache      %12ld\n"
+                 "  in the dictionary   %12ld   (not searched)\n"
+                 "  searched            %12ld\n"
+                 "comparisons           %12ld   (%.1f per search)\n"
+                 "exact matches         %12ld\n"
+                 "corrections           %12ld\n"
+                 "found            ",
+            stats->words, stats->shortWords, stats->longWords, stats->calls, stats->cacheHits, stats->members, stats->searches,
+            stats->comparisons, perSearch, exact, corrWrdCt );
+   for ( k = 0; k <= last; k++ )
+      if ( matcher == MATCHER_SIM )
+         fprintf( out, "  %s %ld", simNames[k], stats->found[k] );
+      else
+         fprintf( out, "  distance %d: %ld", k, stats->found[k] );
+   if ( matcher != MATCHER_SIM )
+      fprintf( out, "  none: %ld", stats->found[MAXL + 1] );
+   fprintf( out, "\nindex                 %s, built in %.3f s%s", modeNames[index->mode], indexSeconds, indexSize );
+   fprintf( out, "\nseconds               load %.3f  tokenize %.3f  search %.3f  output %.3f  total %.3f\n",
+            loadTime, stats->tokenizeTime, stats->searchTime, stats->outputTime, totalTime );
+}
+
+/***************************************** main **********************************************/
+
+long int main(int argc, char *argv[])      // usage: autoSpell [--matcher lev|sim|ocr] [--confusions file] [-i bk|sym|hole|dawg|scan] [-k bit|dp|simd] [-c cache_file] [-m] [-j threads] [--stats[=json]] [-o output_file [--manifest file [--resume]]] text_file_to_correct dictionary
+{
+   const char *progName;                   // argv[0] without its directory
+   FILE *ocrTextFile = NULL;               // the text file to auto-correct for ocr mistakes
+   long int corrWrdCt = 0;                 /* a running count of the number of corrections made - just for reference
+                                              and interest; printed on last line of output */
+   struct autospell_options options;       // options --matcher, -i, -k, -c and --confusions, for autospell_open
+   autospell_dict *d;                      // the dictionary, its index and the cache
+   struct lineContext ctx;                 // what correctLine needs to correct a line
+   _Bool useMmap = 0;                      // option -m: map the whole text file instead of reading it line by line
+   FILE *out = stdout;                     // where the corrected text goes (option -o)
+   const char *outPath = NULL;             // option -o
+   const char *manifestPath = NULL;        // option --manifest: correct block by block, resumably (see the manifest)
+   _Bool resume = 0;                       // option --resume
+   struct stat st;                         // of the text file
+   char *text = NULL;                      // the mapped text file
+   int numThreads = 0;                     // option -j: number of worker threads (0 until known)
+   int threadRc = 0;                       // what correctParallel returned
+   long int return_code = 1;               /* default return code for main(); if negative then one or more words or
+                                              delimiter strings was greater than MAXL and was printed without processing */
+   _Bool compile;                          // compile-dict: write the dictionary image instead of correcting
+   _Bool serve;                            // serve: correct the texts sent to a socket instead of a text file
+   unsigned char requestKind = DAEMON_TEXT;  // client: option --words sends a word list instead of a text
+   struct dictImageHeader newHeader;       // of the image compile-dict writes
+   const void *section[NUM_SECTIONS];      // what compile-dict writes in each section of the image
+   enum statsFormat statsFormat = STATS_NONE;  // option --stats
+   struct runStats stats;                  // --stats: the counts of all the threads
+   struct timespec tStart, tLoaded, tEnd;  // --stats: when the dictionary is started, ready and done with
+   int opt;
+   static const struct option longOpts[] =
+   {
+      { "matcher", required_argument, NULL, 'M' },
+      { "index", required_argument, NULL, 'i' },
+      { "kernel", required_argument, NULL, 'k' },
+      { "cache", required_argument, NULL, 'c' },
+      { "mmap", no_argument, NULL, 'm' },
+      { "jobs", required_argument, NULL, 'j' },
+      { "stats", optional_argument, NULL, 'S' },
+      { "words", no_argument, NULL, 'W' },
+      { "confusions", required_argument, NULL, 'C' },
+      { "output", required_argument, NULL, 'o' },
+      { "manifest", required_argument, NULL, 'F' },
+      { "resume", no_argument, NULL, 'R' },
+      { NULL, 0, NULL, 0 }
+   };
+   
+
+   progName = strrchr( argv[0], '/' ) ? strrchr( argv[0], '/' ) + 1 : argv[0];
+   memset( &options, 0, sizeof( options ) );
+   if ( strcmp( progName, "autoSpellSim" ) == 0 )        // installed under the old names
+      options.matcher = "sim";
+   while ( ( opt = getopt_long( argc, argv, "M:i:k:c:mj:o:", longOpts, NULL ) ) != -1 )
+   {
+      if ( opt == 'M' && ( strcmp( optarg, "lev" ) == 0 || strcmp( optarg, "sim" ) == 0
+                           || strcmp( optarg, "ocr" ) == 0 ) )
+         options.matcher = optarg;
+      else if ( opt == 'C' )
+         options.confusions = optarg;
+      else if ( opt == 'i' && ( strcmp( optarg, "bk" ) == 0 || strcmp( optarg, "sym" ) == 0
+                                || strcmp( optarg, "scan" ) == 0 || strcmp( optarg, "hole" ) == 0
+                                || strcmp( optarg, "dawg" ) == 0 ) )
+         options.index = optarg;
+      else if ( opt == 'k' && ( strcmp( optarg, "bit" ) == 0 || strcmp( optarg, "dp" ) == 0
+                                || strcmp( optarg, "simd" ) == 0 ) )
+         options.kernel = optarg;
+      else if ( opt == 'c' )
+         options.cache = optarg;
+      else if ( opt == 'm' )
+         useMmap = (_Bool) 1;
+      else if ( opt == 'o' )
+         outPath = optarg;
+      else if ( opt == 'F' )
+         manifestPath = optarg;
+      else if ( opt == 'R' )
+         resume = (_Bool) 1;
+      else if ( opt == 'j' && ( numThreads = atoi( optarg ) ) >= 1 )
+         ;
+      else if ( opt == 'S' && ( optarg == NULL || strcmp( optarg, "text" ) == 0 ) )
+         statsFormat = STATS_TEXT;
+      else if ( opt == 'S' && strcmp( optarg, "json" ) == 0 )
+         statsFormat = STATS_JSON;
+      else if ( opt == 'W' )
+         requestKind = DAEMON_WORDS;
+      else
+      {
+         fprintf (stderr, "usage: %s [--matcher lev|sim|ocr] [--confusions file] [-i bk|sym|hole|dawg|scan] [-k bit|dp|simd] [-c cache_file] [-m] [-j threads] [--stats[=json]] [-o output_file [--manifest file [--resume]]] text_file_to_correct dictionary\n"
+                          "       %s [--matcher lev|sim|ocr] [-i bk|sym|hole|dawg|scan] compile-dict dictionary image\n"
+                          "       %s [--matcher lev|sim|ocr] [--confusions file] [-i bk|sym|hole|dawg|scan] [-k bit|dp|simd] [-c cache_file] [-j threads] serve dictionary socket\n"
+                          "       %s [--words] client socket text_file_to_correct\n",
+                  progName, progName, progName, progName);
+         return -1;
+      }
+   }
+
+   compile = argc - optind == 3 && strcmp( argv[optind], "compile-dict" ) == 0;
+   serve = argc - optind == 3 && strcmp( argv[optind], "serve" ) == 0;
+   if ( numThreads == 0 )                  // no -j: one thread, or to serve one for each processor
+      numThreads = serve && sysconf( _SC_NPROCESSORS_ONLN ) > 1 ? (int) sysconf( _SC_NPROCESSORS_ONLN ) : 1;
+   if ( argc - optind == 3 && strcmp( argv[optind], "client" ) == 0 )
+      return runClient( argv[optind + 1], argv[optind + 2], requestKind );   // the daemon has the dictionary
+   if ( ( manifestPath && !outPath ) || ( resume && !manifestPath ) )
+   {
+      fprintf (stderr, "--manifest needs -o output_file, and --resume needs --manifest\n");
+      return -1;
+   }
+   if ( argc - optind != 2 && !compile && !serve )
+   {
+      fprintf (stderr, "required input of textfile with ocr errors and word list used to automatically correct it\n");
+      return -1;
+   };
+
+   if ( compile || serve )
+      ;
+   else if ( strcmp( argv[optind], "-" ) == 0 )
+      ocrTextFile = stdin;
+   else if ( (ocrTextFile = fopen (argv[optind], "r")) == NULL )
+   {
+      fprintf (stderr, "cannot read the input text file %s\n", argv[optind]);
+      return -2;
+   };  
+
+// now the main body......................................
+
+   clock_gettime( CLOCK_MONOTONIC, &tStart );
+   if ( compile )                          // the image holds no cache, and no buckets for the SIMD kernels
+      options.kernel = options.cache = NULL;
+   if ( ( opt = autospell_open( argv[optind + 1], &options, &d ) ) < 0 )
+      return opt;
+
+   if ( compile )
+   {
+      memset( &newHeader, 0, sizeof( newHeader ) );
+      memset( section, 0, sizeof( section ) );
+      newHeader.numWords = (unsigned long long) d->dict.numWords;
+      newHeader.lastWordSize = d->lastWordSize;
+      newHeader.dictHash = d->dictHash;
+      for ( opt = 0; opt <= MAXL + 1; opt++ )
+         newHeader.wordLenIndex[opt] = d->wordLenIndex[opt];
+      memcpy( newHeader.wide, d->dict.wide, sizeof( newHeader.wide ) );
+      newHeader.numWide = (unsigned int) d->dict.numWide;
+      section[SECTION_WORDS] = d->dict.arena;
+      newHeader.size[SECTION_WORDS] = d->dict.offset ? d->dict.offset[d->dict.numWords] : 0;
+      section[SECTION_OFFSETS] = d->dict.offset;
+      newHeader.size[SECTION_OFFSETS] = (unsigned long long) ( d->dict.numWords + 1 ) * sizeof( *d->dict.offset );
+      section[SECTION_EXACT] = d->index.exact.slots;
+      newHeader.size[SECTION_EXACT] = ( d->index.exact.mask + 1 ) * sizeof( *d->index.exact.slots );
+      newHeader.exactMask = d->index.exact.mask;
+      section[SECTION_FREQ] = d->dict.freq;
+      newHeader.size[SECTION_FREQ] = d->dict.freq ? (unsigned long long) d->dict.numWords * sizeof( *d->dict.freq ) : 0;
+      if ( d->index.mode == INDEX_BK )
+      {
+         section[SECTION_BK] = d->index.bkTree;
+         newHeader.size[SECTION_BK] = (unsigned long long) d->dict.numWords * sizeof( *d->index.bkTree );
+      }
+      else if ( d->index.mode == INDEX_SYM )
+      {
+         section[SECTION_SYM_SLOTS] = d->index.sym.slots;
+         newHeader.size[SECTION_SYM_SLOTS] = ( d->index.sym.mask + 1 ) * sizeof( *d->index.sym.slots );
+         section[SECTION_SYM_POSTING] = d->index.sym.posting;
+         newHeader.size[SECTION_SYM_POSTING] = d->index.sym.numPostings * sizeof( *d->index.sym.posting );
+         newHeader.symMask = d->index.sym.mask;
+      }
+      else if ( d->index.mode == INDEX_HOLE )
+      {
+         section[SECTION_HOLE_SLOTS] = d->index.hole.slots;
+         newHeader.size[SECTION_HOLE_SLOTS] = ( d->index.hole.mask + 1 ) * sizeof( *d->index.hole.slots );
+         section[SECTION_HOLE_POSTING] = d->index.hole.posting;
+         newHeader.size[SECTION_HOLE_POSTING] = d->index.hole.numPostings * sizeof( *d->index.hole.posting );
+         newHeader.holeMask = d->index.hole.mask;
+      }
+      else if ( d->index.mode == INDEX_DAWG )
+      {
+         section[SECTION_DAWG] = d->index.dawg;
+         newHeader.size[SECTION_DAWG] = d->index.dawgNodes * sizeof( *d->index.dawg );
+         section[SECTION_DAWG_WORDS] = d->index.dawgWord;
+         newHeader.size[SECTION_DAWG_WORDS] = d->index.dawgWords * sizeof( *d->index.dawgWord );
+         newHeader.dawgRoot = d->index.dawgRoot;
+      }
+      return_code = writeDictImage( argv[optind + 2], &newHeader, section );
+      if ( return_code != 0 )
+         fprintf (stderr, "cannot write the dictionary image %s\n", argv[optind + 2]);
+      autospell_close( d );
+      return return_code == 0 ? 0 : -2;
+   }
+
+   ctx = d->ctx;
+   memset( &stats, 0, sizeof( stats ) );
+   ctx.stats = statsFormat != STATS_NONE ? &stats : NULL;
+   clock_gettime( CLOCK_MONOTONIC, &tLoaded );
+   if ( serve )
+   {
+      ctx.stats = NULL;
+      return_code = serveDaemon( &ctx, argv[optind + 2], numThreads );
+      if ( ctx.cache )                     // the threads may still be correcting: save what they found so far
+      {
+         pthread_mutex_lock( &ctx.cache->lock );
+         if ( cacheSave( ctx.cache ) != 0 )
+            fprintf (stderr, "cannot write the cache file %s\n", options.cache);
+      }
+      return return_code;                  // and leave the dictionary to the exit, under the threads' feet
+   }
+   if ( ( useMmap || numThreads > 1 || manifestPath ) && fstat( fileno( ocrTextFile ), &st ) == 0
+        && S_ISREG( st.st_mode ) && st.st_size > 0 )
+      text = mmap( NULL, (size_t) st.st_size, PROT_READ, MAP_PRIVATE, fileno( ocrTextFile ), 0 );
+   if ( text == MAP_FAILED )
+   {
+      fprintf (stderr, "cannot map the input text file %s; reading it instead\n", argv[optind]);
+      text = NULL;
+   }
+   if ( manifestPath && text == NULL )
+   {
+      fprintf (stderr, "--manifest needs a text file that can be mapped, not %s\n", argv[optind]);
+      return -2;
+   }
+   if ( outPath && !manifestPath && ( out = fopen( outPath, "w" ) ) == NULL )
+   {
+      fprintf (stderr, "cannot write the output file %s\n", outPath);
+      return -2;
+   }
+   if ( manifestPath )
+   {
+      (void) madvise( text, (size_t) st.st_size, MADV_SEQUENTIAL );
+      threadRc = correctManifest( &ctx, text, (size_t) st.st_size, numThreads, outPath, manifestPath, d->fingerprint,
+                                  resume, &corrWrdCt, &return_code );
+      munmap( text, (size_t) st.st_size );
+      if ( threadRc == -2 || threadRc == -4 )
+      {
+         fprintf (stderr, threadRc == -2 ? "cannot write the output file %s or the manifest %s\n"
+                                         : "cannot allocate memory for the manifest\n", outPath, manifestPath);
+         return_code = threadRc;
+         threadRc = 0;
+      }
+   }
+   else if ( text != NULL )
+   {
+      (void) madvise( text, (size_t) st.st_size, MADV_SEQUENTIAL );
+      if ( numThreads > 1 )
+         threadRc = correctParallel( &ctx, text, (size_t) st.st_size, numThreads, out, &corrWrdCt, &return_code );
+      else
+         correctText( &ctx, text, (size_t) st.st_size, out, &corrWrdCt, &return_code );
+      munmap( text, (size_t) st.st_size );
+   }
+   else                                                      // read in blocks: a pipe, or a file not mapped
+      threadRc = correctStream( &ctx, ocrTextFile, numThreads, out, &corrWrdCt, &return_code );
+   if ( threadRc != 0 )
+   {
+      fprintf (stderr, "cannot start the worker threads or allocate their memory\n");
+      return_code = -7;
+   }
+
+   if ( ocrTextFile != stdin )
+      fclose(ocrTextFile);
+   if ( out != stdout && fclose( out ) != 0 )
+   {
+      fprintf (stderr, "cannot write the output file %s\n", outPath);
+      return_code = -2;
+   }
+   if ( statsFormat != STATS_NONE )
+   {
+      clock_gettime( CLOCK_MONOTONIC, &tEnd );
+      statsAdd( &stats, &threadStats );                     // the main thread's own (all of them without -j)
+      fflush( stdout );
+      printStats( stderr, statsFormat, &stats, &d->index, d->indexSeconds, corrWrdCt,
+                  (double) ( tLoaded.tv_sec - tStart.tv_sec ) + (double) ( tLoaded.tv_nsec - tStart.tv_nsec ) / 1e9,
+                  (double) ( tEnd.tv_sec - tStart.tv_sec ) + (double) ( tEnd.tv_nsec - tStart.tv_nsec ) / 1e9 );
+   }
+   autospell_close( d );                   // which saves the cache
+   if ( return_code > 0 )
+      return_code = corrWrdCt;
+   return return_code;   // echo $? to get return value which equals number of corrections made if no errors
+}
+
+#endif /* AUTOSPELL_NO_MAIN */
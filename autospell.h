@@ -0,0 +1,98 @@
+/*  autospell.h - the library interface of autoSpell
+    Copyright (C) 2016  Perry T Jennings
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    any later version.
+
+The same code as the autoSpell program, built without its main:
+
+   cc -O2 -pthread -fPIC -shared -DAUTOSPELL_NO_MAIN -o libautospell.so autoSpell.c
+   cc -O2 -pthread -c -DAUTOSPELL_NO_MAIN -o autospell.o autoSpell.c && ar rcs libautospell.a autospell.o
+
+A dictionary is opened once (read and indexed, or mapped if it is an image written by compile-dict) and may then
+be used by any number of threads at the same time until it is closed.  Nothing is printed to standard output and
+nothing exits: every function returns one of the AUTOSPELL_E codes below (the exit codes of the program) on an
+error, though the reason is also written to standard error as the program does. */
+
+#ifndef AUTOSPELL_H
+#define AUTOSPELL_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define AUTOSPELL_MAXL 30              // the most characters of a word searched for: MAXL of autoSpell.c
+#define AUTOSPELL_MAXB ( 4 * AUTOSPELL_MAXL )  // the most bytes of such a word in UTF-8
+
+#define AUTOSPELL_EUSAGE -1            // an option has an unknown value (or the confusion table is bad)
+#define AUTOSPELL_EFILE -2             // the cache file cannot be written
+#define AUTOSPELL_EDICT -3             // the dictionary cannot be read, is not sorted or is a bad image
+#define AUTOSPELL_ENOMEM -4
+#define AUTOSPELL_ELONGDELIM -5        // a run of delimiters longer than AUTOSPELL_MAXL was copied as it is
+#define AUTOSPELL_ELONGWORD -6         // a word longer than AUTOSPELL_MAXL was copied as it is
+#define AUTOSPELL_ESPACE -9            // the output buffer is too small
+
+typedef struct autospell_dict autospell_dict;
+
+struct autospell_options           // as the options of the program; NULL for the default
+{
+   const char *matcher;            // --matcher: "lev" (default), "sim" or "ocr"
+   const char *index;              // -i: "bk", "sym", "hole", "dawg" or "scan"
+   const char *kernel;             // -k: "bit", "dp" or "simd"
+   const char *cache;              // -c: the cache file, saved by autospell_close
+   const char *confusions;         // --confusions: the ocr matcher's cost table (NULL for the built in one)
+};
+
+struct autospell_span              // a word handed to autospell_correct_words
+{
+   const char *text;               // not null-terminated
+   size_t length;
+};
+
+struct autospell_word              // what autospell_correct_words made of a word
+{
+   char text[AUTOSPELL_MAXB + 1];  // the word, corrected or not (empty if status < 0)
+   int status;                     // as autospell_correct_word returns
+};
+
+/* Open the dictionary at path (a word list sorted from shortest to longest, or an image written by compile-dict)
+   with options (NULL for all the defaults) into *dict.  Returns 0, AUTOSPELL_EUSAGE, AUTOSPELL_EDICT or
+   AUTOSPELL_ENOMEM. */
+int autospell_open ( const char *path, const struct autospell_options *options, autospell_dict **dict );
+
+/* Save the cache (if one was asked for) and free the dictionary, which no thread may still be using.  Returns 0,
+   or AUTOSPELL_EFILE if the cache could not be written. */
+int autospell_close ( autospell_dict *dict );
+
+/* Copy to out the length bytes of the UTF-8 word, corrected if the dictionary has a replacement.  Words too short
+   to search (fewer than 7 characters, 9 with the sim matcher) or longer than any dictionary word are copied as they
+   are.  Returns 1 if the word was corrected, 0 if not, or AUTOSPELL_ELONGWORD (and out is empty) if it has more
+   than AUTOSPELL_MAXL characters. */
+int autospell_correct_word ( const autospell_dict *dict, const char *word, size_t length, char out[AUTOSPELL_MAXB + 1] );
+
+/* autospell_correct_word for each of the n words; out[i] is what became of words[i].  Returns the number of words
+   corrected. */
+long int autospell_correct_words ( const autospell_dict *dict, const struct autospell_span words[], size_t n,
+                                   struct autospell_word out[] );
+
+/* Correct the textLen bytes of the UTF-8 text as the program corrects a text file, writing the result into out,
+   which has room for outSize bytes, and its length to *outLen (out is not null-terminated).  With the lev and sim
+   matchers a correction has no more characters than the word it replaces, but may have more bytes (an accent put
+   on a letter), so outSize = 4 * textLen is always enough, and textLen is with an ASCII dictionary.  The ocr
+   matcher also puts back letters ocr dropped, so a word of 7 characters may become one of up to AUTOSPELL_MAXL
+   characters: outSize = textLen / 7 * AUTOSPELL_MAXB + textLen is enough for it.  Otherwise call again with an
+   out of *outLen bytes after AUTOSPELL_ESPACE.  Returns the number of words corrected, AUTOSPELL_ELONGDELIM or
+   AUTOSPELL_ELONGWORD (the text is still all there, corrected), AUTOSPELL_ENOMEM, or AUTOSPELL_ESPACE if out is
+   too small (*outLen is then the size needed and out is untouched). */
+long int autospell_correct_buffer ( const autospell_dict *dict, const char *text, size_t textLen, char *out,
+                                    size_t outSize, size_t *outLen );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AUTOSPELL_H */
@@ -0,0 +1,455 @@
+#define AUTOSPELL_NO_MAIN
+#include "../autoSpell.c"
+
+/*  -=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+    autoSpellBench - times the kernels of autoSpell one by one
+
+usage: autoSpellBench [-q lookups] [-r rounds] [-s seed] dictionary > results.json
+
+build: cc -O2 -pthread -o autoSpellBench bench/autoSpellBench.c
+
+The program includes autoSpell.c itself (without its main) so it times exactly the functions autoSpell runs, and
+prints one JSON object to standard output so that the results of two commits can be diffed.  Each entry of
+"results" has the name of the kernel, the number of operations timed ("ops"), "ns_per_op" and "ops_per_sec", plus:
+
+levenshtein, levenshteinBits, simWords
+          "length" and "edits": an op is one pair of random words of length characters, the second being the first
+          with edits characters substituted.  levenshteinBits is timed with its pattern already made (as the
+          bucket scan uses it) and no bound; levPrepare is timed on its own.
+nextToken
+          an op is one token of about 8 MB of dictionary words and delimiters; also "mb_per_sec".
+readWordList
+          an op is one word of the dictionary word list read into the arena; also "mb_per_sec".
+returnWord
+          "matcher", "index" and "scorer" as the options --matcher, -i and -k of autoSpell; an op is one lookup
+          of a dictionary word of at least minCharWord characters with one character substituted, so most lookups
+          are corrected and few end with an exact match.  "comparisons_per_lookup" is the number of dictionary
+          words scored per lookup, as counted for --stats.
+
+The input of every kernel is made before its clock starts.  -r repeats each kernel over its input rounds times
+(default 5), -q sets the number of lookups for returnWord (default 2000) and -s the seed of the random words
+(default 1).  The dictionary must be a word list, not an image.
+-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= */
+
+#define NUM_PAIRS 4096            // word pairs per length and number of edits
+
+static volatile long int benchSink;             // kernel results go here so they are not optimized away
+static unsigned long long rngState;
+static _Bool firstResult = 1;                   // no comma before the first entry of "results"
+
+/***************************** function rng ******************************/
+
+static unsigned long int rng ( const unsigned long int n )
+{
+   // function to return a pseudo random number in 0..n-1 (xorshift64*), the same on every machine for a seed
+
+   rngState ^= rngState >> 12;
+   rngState ^= rngState << 25;
+   rngState ^= rngState >> 27;
+   return (unsigned long int) ( ( rngState * 2685821657736338717ULL ) >> 33 ) % n;
+}
+
+/***************************** function nowNs ******************************/
+
+static double nowNs ( void )
+{
+   struct timespec t;
+
+   clock_gettime( CLOCK_MONOTONIC, &t );
+   return (double) t.tv_sec * 1e9 + (double) t.tv_nsec;
+}
+
+/***************************** function substitute ******************************/
+
+static void substitute ( char *word, const int len, const int edits )
+{
+   // function to change edits different characters of word (of len characters) each to another lower case letter
+
+   _Bool changed[MAXL] = { 0 };
+   int e, j;
+
+   for ( e = 0; e < edits && e < len; e++ )
+   {
+      do
+         j = (int) rng( (unsigned long int) len );
+      while ( changed[j] );
+      changed[j] = (_Bool) 1;
+      if ( word[j] >= 'a' && word[j] <= 'z' )
+         word[j] = (char) ( 'a' + ( word[j] - 'a' + 1 + (int) rng( 25 ) ) % 26 );
+      else
+         word[j] = (char) ( 'a' + rng( 26 ) );
+   }
+}
+
+/***************************** function printResult ******************************/
+
+static void printResult ( const char *kernel, const char *extra, const double ops, const double ns )
+{
+   // function to print one entry of "results"; extra is more members ( , "name": value ... ) or ""
+
+   printf( "%s\n    { \"kernel\": \"%s\"%s, \"ops\": %.0f, \"ns_per_op\": %.2f, \"ops_per_sec\": %.0f }",
+           firstResult ? "" : ",", kernel, extra, ops, ops > 0 ? ns / ops : 0.0, ns > 0 ? ops / ns * 1e9 : 0.0 );
+   firstResult = (_Bool) 0;
+}
+
+/***************************** function printJsonString ******************************/
+
+static void printJsonString ( const char *s )
+{
+   putchar( '"' );
+   for ( ; *s; s++ )
+      if ( *s == '"' || *s == '\\' )
+         printf( "\\%c", *s );
+      else if ( (unsigned char) *s < 0x20 )
+         printf( "\\u%04x", (unsigned char) *s );
+      else
+         putchar( *s );
+   putchar( '"' );
+}
+
+/***************************** function benchPairs ******************************/
+
+static void benchPairs ( const int rounds )
+{
+   // function to time levenshtein, levenshteinBits, simWords and levPrepare on word pairs of controlled length and edits
+
+   static const int lengths[] = { 5, 7, 10, 15, 20, 30 };
+   static char a[NUM_PAIRS][MAXL + 1], b[NUM_PAIRS][MAXL + 1];
+   static struct levPattern pattern[NUM_PAIRS];
+   char extra[64];
+   double t;
+   long int sum = 0;
+   int l, edits, k, j, r, len;
+
+   for ( l = 0; l < (int) ( sizeof( lengths ) / sizeof( lengths[0] ) ); l++ )
+      for ( edits = 0; edits <= 3; edits++ )
+      {
+         len = lengths[l];
+         for ( k = 0; k < NUM_PAIRS; k++ )
+         {
+            for ( j = 0; j < len; j++ )
+               a[k][j] = (char) ( 'a' + rng( 26 ) );
+            a[k][len] = '\0';
+            memcpy( b[k], a[k], (size_t) len + 1 );
+            substitute( b[k], len, edits );
+            levPrepare( &pattern[k], a[k] );
+         }
+         snprintf( extra, sizeof( extra ), ", \"length\": %d, \"edits\": %d", len, edits );
+
+         t = nowNs();
+         for ( r = 0; r < rounds; r++ )
+            for ( k = 0; k < NUM_PAIRS; k++ )
+               sum += levenshtein( a[k], b[k] );
+         printResult( "levenshtein", extra, (double) rounds * NUM_PAIRS, nowNs() - t );
+
+         t = nowNs();
+         for ( r = 0; r < rounds; r++ )
+            for ( k = 0; k < NUM_PAIRS; k++ )
+               sum += levenshteinBits( &pattern[k], b[k], MAXL + 1 );
+         printResult( "levenshteinBits", extra, (double) rounds * NUM_PAIRS, nowNs() - t );
+
+         t = nowNs();
+         for ( r = 0; r < rounds; r++ )
+            for ( k = 0; k < NUM_PAIRS; k++ )
+               sum += simWords( a[k], b[k] );
+         printResult( "simWords", extra, (double) rounds * NUM_PAIRS, nowNs() - t );
+      }
+
+   t = nowNs();
+   for ( r = 0; r < rounds; r++ )
+      for ( k = 0; k < NUM_PAIRS; k++ )
+      {
+         levPrepare( &pattern[k], a[k] );
+         sum += (long int) pattern[k].peq['a'];
+      }
+   printResult( "levPrepare", ", \"length\": 30", (double) rounds * NUM_PAIRS, nowNs() - t );
+   benchSink = sum;
+}
+
+/***************************** function benchTokenizer ******************************/
+
+static int benchTokenizer ( const struct dictionary *dict, const int rounds )
+{
+   // function to time nextToken over about 8 MB of random dictionary words separated by runs of the delimiters
+
+   static const char delimiters[] = DELIMITERS;
+   const size_t size = (size_t) 8 << 20;
+   unsigned char delimTable[256];
+   struct tokenSpan span;
+   size_t used = 0, cursor;
+   char *text;
+   char extra[64];
+   double t, tokens = 0;
+   long int w, sum = 0;
+   int r, n;
+
+   if ( ( text = malloc( size ) ) == NULL )
+      return -1;
+   makeDelimTable( delimTable, delimiters );
+   while ( used + MAXL + 2 < size )
+   {
+      w = (long int) rng( (unsigned long int) dict->numWords );
+      n = dictLength( dict, w );
+      memcpy( text + used, dictWord( dict, w ), (size_t) n );
+      used += (size_t) n;
+      text[used++] = delimiters[rng( sizeof( delimiters ) - 1 )];
+      if ( rng( 4 ) == 0 )                                  // a comma and a space and the like
+         text[used++] = delimiters[rng( sizeof( delimiters ) - 1 )];
+   }
+
+   t = nowNs();
+   for ( r = 0; r < rounds; r++ )
+   {
+      cursor = 0;
+      while ( nextToken( delimTable, text, used, &cursor, &span ) )
+      {
+         sum += (long int) span.length;
+         tokens++;
+      }
+   }
+   t = nowNs() - t;
+   benchSink = sum;
+   snprintf( extra, sizeof( extra ), ", \"mb_per_sec\": %.1f", (double) used * rounds / t * 1e3 );
+   printResult( "nextToken", extra, tokens, t );
+   free( text );
+   return 0;
+}
+
+/***************************** function benchLoader ******************************/
+
+static int benchLoader ( const char *path, const int rounds )
+{
+   // function to time readWordList reading the word list path into a new arena, rounds times
+
+   struct dictionary dict;
+   long int wordLenIndex[MAXL + 2];
+   size_t lastWordSize;
+   unsigned long long dictHash;
+   struct stat st;
+   FILE *wordList;
+   char extra[64];
+   double t = 0, t0, words = 0;
+   int r, rc = 0;
+
+   for ( r = 0; r < rounds && rc == 0; r++ )
+   {
+      if ( ( wordList = fopen( path, "r" ) ) == NULL )
+         return -3;
+      memset( &dict, 0, sizeof( dict ) );
+      memset( wordLenIndex, 0, sizeof( wordLenIndex ) );
+      lastWordSize = 0;
+      dictHash = 14695981039346656037ULL;
+      t0 = nowNs();
+      rc = (int) readWordList( wordList, &dict, wordLenIndex, &lastWordSize, &dictHash );
+      t += nowNs() - t0;
+      words += (double) dict.numWords;
+      fclose( wordList );
+      free( dict.arena );
+      free( dict.offset );
+      free( dict.freq );
+   }
+   if ( rc != 0 || stat( path, &st ) != 0 )
+      return rc == -2 ? -4 : -3;
+   snprintf( extra, sizeof( extra ), ", \"mb_per_sec\": %.1f", (double) st.st_size * rounds / t * 1e3 );
+   printResult( "readWordList", extra, words, t );
+   return 0;
+}
+
+/***************************** function benchLookups ******************************/
+
+struct lookupConfig               // one way of running returnWord
+{
+   enum matcher matcher;
+   enum indexMode mode;
+   enum kernel kernel;
+   const char *matcherName, *modeName, *kernelName;
+};
+
+static int benchLookups ( const struct dictionary *dict, const long int *wordLenIndex, const int numLookups,
+                          const int rounds )
+{
+   /* function to time returnWord for each matcher and index mode on numLookups misspelled dictionary words and count
+      the dictionary words it scores per lookup.  Returns 0, or -4 if memory ran out for an index. */
+
+   static const struct lookupConfig configs[] =
+   {
+      { MATCHER_LEV, INDEX_SCAN, KERNEL_BIT, "lev", "scan", "bit" },
+      { MATCHER_LEV, INDEX_SCAN, KERNEL_DP, "lev", "scan", "dp" },
+      { MATCHER_LEV, INDEX_SCAN, KERNEL_SIMD, "lev", "scan", "simd" },
+      { MATCHER_LEV, INDEX_BK, KERNEL_BIT, "lev", "bk", "bit" },
+      { MATCHER_LEV, INDEX_SYM, KERNEL_BIT, "lev", "sym", "bit" },
+      { MATCHER_LEV, INDEX_DAWG, KERNEL_BIT, "lev", "dawg", "bit" },
+      { MATCHER_SIM, INDEX_SCAN, KERNEL_BIT, "sim", "scan", "bit" },
+      { MATCHER_SIM, INDEX_HOLE, KERNEL_BIT, "sim", "hole", "bit" },
+      { MATCHER_OCR, INDEX_TRIE, KERNEL_BIT, "ocr", "trie", "bit" }
+   };
+   static struct searchIndex index;
+   static struct confusionTable confusions;
+   struct bkNode *bkTree = NULL;
+   struct symIndex sym, hole;
+   char (*lookup)[MAXL + 1];
+   char outputWord[MAXL + 1];
+   char extra[160];
+   long int corrected = 0, comparisons, w;
+   double t;
+   int c, k, r, len, minCharWord, tries, rc = 0;
+
+   if ( ( lookup = malloc( (size_t) numLookups * sizeof( *lookup ) ) ) == NULL )
+      return -4;
+   memset( &sym, 0, sizeof( sym ) );
+   memset( &hole, 0, sizeof( hole ) );
+   index.levBlock = pickLevBlock();
+   if ( index.levBlock && transposeBuild( index.transposed, dict, wordLenIndex ) != 0 )
+      rc = -4;
+   else if ( ( bkTree = malloc( (size_t) dict->numWords * sizeof( *bkTree ) ) ) == NULL
+             || symBuild( &sym, dict, wordLenIndex ) != 0 || holeBuild( &hole, dict ) != 0 || dawgBuild( &index, dict ) != 0
+             || ( index.trieNodes = trieBuild( &index.trie, dict ) ) < 0 || ocrTableLoad( &confusions, dict, NULL ) != 0 )
+      rc = -4;
+   else
+   {
+      index.kernel = KERNEL_BIT;
+      index.confusions = &confusions;      // the built-in table, as without --confusions
+      bkBuild( bkTree, dict, wordLenIndex, &index );
+   }
+
+   for ( c = 0; c < (int) ( sizeof( configs ) / sizeof( configs[0] ) ) && rc == 0; c++ )
+   {
+      if ( configs[c].kernel == KERNEL_SIMD && index.levBlock == NULL )
+         continue;                                           // neither AVX2 nor SSE4.2
+      minCharWord = configs[c].matcher == MATCHER_SIM ? 9 : 7;
+      if ( c == 0 || configs[c].matcher != configs[c - 1].matcher )
+      {
+         for ( k = 0; k < numLookups; k++ )                  // the same lookups for every mode of a matcher
+         {
+            lookup[k][0] = '\0';
+            for ( tries = 0; tries < 1000 && lookup[k][0] == '\0'; tries++ )
+            {
+               w = (long int) rng( (unsigned long int) dict->numWords );
+               len = dictLength( dict, w );
+               if ( len >= minCharWord && len <= MAXL && wordLenIndex[len] != 0 )
+               {
+                  memcpy( lookup[k], dictWord( dict, w ), (size_t) len + 1 );
+                  substitute( lookup[k], len, 1 );
+               }
+            }
+            if ( lookup[k][0] == '\0' )
+               break;                                        // hardly any words long enough
+         }
+         if ( k < numLookups )
+            continue;
+      }
+      index.matcher = configs[c].matcher;
+      index.mode = configs[c].mode;
+      index.kernel = configs[c].kernel;
+      index.bkTree = bkTree;
+      index.sym = sym;
+      index.hole = hole;
+
+      comparisons = threadStats.comparisons;
+      t = nowNs();
+      for ( r = 0; r < rounds; r++ )
+         for ( k = 0; k < numLookups; k++ )
+            returnWord( outputWord, lookup[k], (int) strlen( lookup[k] ), dict, wordLenIndex, &index, NULL, &corrected );
+      t = nowNs() - t;
+
+      snprintf( extra, sizeof( extra ), ", \"matcher\": \"%s\", \"index\": \"%s\", \"scorer\": \"%s\", "
+                "\"comparisons_per_lookup\": %.1f", configs[c].matcherName, configs[c].modeName,
+                configs[c].kernelName, (double) ( threadStats.comparisons - comparisons ) / ( (double) rounds * numLookups ) );
+      printResult( "returnWord", extra, (double) rounds * numLookups, t );
+   }
+   benchSink = corrected;
+
+   for ( k = 0; k <= MAXL; k++ )
+      free( index.transposed[k].chars );
+   free( bkTree );
+   free( sym.slots );
+   free( sym.posting );
+   free( hole.slots );
+   free( hole.posting );
+   free( index.dawg );
+   free( index.dawgWord );
+   free( index.trie );
+   free( lookup );
+   return rc;
+}
+
+/***************************************** main **********************************************/
+
+int main ( int argc, char *argv[] )
+{
+   struct dictionary dict = { 0 };
+   long int wordLenIndex[MAXL + 2] = { 0 };
+   size_t lastWordSize = 0;
+   unsigned long long dictHash = 14695981039346656037ULL;
+   unsigned long long seed = 1;
+   int numLookups = 2000, rounds = 5;
+   int opt, rc = 0;
+   void *image;
+   size_t imageSize;
+   FILE *wordList;
+
+   while ( ( opt = getopt( argc, argv, "q:r:s:" ) ) != -1 )
+   {
+      if ( opt == 'q' && ( numLookups = atoi( optarg ) ) >= 1 )
+         ;
+      else if ( opt == 'r' && ( rounds = atoi( optarg ) ) >= 1 )
+         ;
+      else if ( opt == 's' )
+         seed = strtoull( optarg, NULL, 10 );
+      else
+         break;
+   }
+   if ( opt != -1 || argc - optind != 1 )
+   {
+      fprintf (stderr, "usage: autoSpellBench [-q lookups] [-r rounds] [-s seed] dictionary > results.json\n");
+      return -1;
+   }
+   rngState = seed * 0x9e3779b97f4a7c15ULL + 1;              // never 0, which xorshift would keep
+
+   if ( mapDictImage( argv[optind], &image, &imageSize ) == 0 )
+   {
+      munmap( image, imageSize );
+      fprintf (stderr, "the dictionary %s is an image; autoSpellBench reads word lists only\n", argv[optind]);
+      return -3;
+   }
+   if ( ( wordList = fopen( argv[optind], "r" ) ) == NULL )
+   {
+      fprintf (stderr, "cannot read the input dictionary %s\n", argv[optind]);
+      return -3;
+   }
+   opt = (int) readWordList( wordList, &dict, wordLenIndex, &lastWordSize, &dictHash );
+   fclose( wordList );
+   if ( opt != 0 || dict.numWords == 0 )
+   {
+      if ( opt == -3 )
+         fprintf (stderr, "the input dictionary has more than %d different non-ASCII characters\n",
+                  NARROW_OTHER - NARROW_FIRST);
+      else
+         fprintf (stderr, opt == -2 ? "cannot allocate memory for the dictionary\n"
+                                    : "the input dictionary is empty or not properly sorted\n");
+      free( dict.arena );
+      free( dict.offset );
+      free( dict.freq );
+      return opt == -2 ? -4 : -3;
+   }
+
+   printf( "{\n  \"program\": \"autoSpellBench\",\n  \"dictionary\": " );
+   printJsonString( argv[optind] );
+   printf( ",\n  \"words\": %ld,\n  \"maxl\": %d,\n  \"seed\": %llu,\n  \"rounds\": %d,\n  \"lookups\": %d,\n"
+           "  \"results\": [", dict.numWords, MAXL, seed, rounds, numLookups );
+   benchPairs( rounds );
+   if ( ( rc = benchTokenizer( &dict, rounds ) ) == 0 && ( rc = benchLoader( argv[optind], rounds ) ) == 0 )
+      rc = benchLookups( &dict, wordLenIndex, numLookups, rounds );
+   if ( rc == -1 )
+      rc = -4;
+   printf( "\n  ]\n}\n" );
+   if ( rc != 0 )
+      fprintf (stderr, rc == -4 ? "cannot allocate memory for a benchmark\n" : "cannot read the input dictionary %s\n",
+               argv[optind]);
+
+   free( dict.arena );
+   free( dict.offset );
+   free( dict.freq );
+   return rc;
+}
@@ -0,0 +1,70 @@
+#!/bin/bash -
+#
+# script ocrBench.sh
+# purpose - to measure the speed and the accuracy of autoSpell together: a clean text is repeated to each size,
+# ocr-like errors are put in it with ocrNoise, and each matcher corrects it.  One line of JSON is printed per size
+# and matcher with the throughput, the peak resident memory, the start up time (autoSpell on an empty text, so
+# reading the dictionary and building its index) and the precision and recall of the corrections.
+#
+# usage: ocrBench.sh clean_text dictionary [size_in_MB ...]          (default sizes 1 10 100 1000)
+#
+# The dictionary should be made from the same kind of text with the scripts in how_to_create_a_dictionary.
+# These may be set in the environment:
+#   AUTOSPELL        the program to measure (default ./autoSpell)
+#   OCRNOISE         the ocrNoise program (default ./ocrNoise)
+#   AUTOSPELL_OPTS   more options for autoSpell, such as "-j 4 -m"
+#   NOISE_OPTS       options for ocrNoise, such as "-s 0.05 -p 0.05 -r 2"
+#   WORK             where the texts are made (default a new directory in /tmp, removed at the end)
+#
+# build the programs first:
+#   cc -O2 -pthread -o autoSpell autoSpell.c
+#   cc -O2 -pthread -o ocrNoise bench/ocrNoise.c
+
+if [ $# -lt 2 ]; then
+  echo "usage: $0 clean_text dictionary [size_in_MB ...]" >&2
+  exit 1
+fi
+clean=$1
+dict=$2
+shift 2
+if [ ! -s "$clean" ]; then
+  echo "$0: $clean is missing or empty, so it cannot be repeated to any size" >&2
+  exit 1
+fi
+sizes=${*:-1 10 100 1000}
+AUTOSPELL=${AUTOSPELL:-./autoSpell}
+OCRNOISE=${OCRNOISE:-./ocrNoise}
+if [ -z "$WORK" ]; then
+  WORK=$(mktemp -d /tmp/ocrBench.XXXXXX) || exit 1
+  trap 'rm -rf "$WORK"' EXIT
+fi
+
+# the members of a one line JSON object, without its braces
+members() { sed -e 's/^{ *//' -e 's/ *}$//'; }
+
+# value of member $1 of the one line JSON object on standard input
+member() { sed -n "s/.*\"$1\": *\([^,}]*\).*/\1/p"; }
+
+: > "$WORK/empty"
+for size in $sizes; do
+  bytes=$((size * 1024 * 1024))
+  : > "$WORK/clean"
+  while [ "$(stat -c %s "$WORK/clean")" -lt $bytes ]; do
+    cat "$clean" >> "$WORK/clean"
+  done
+  truncate -s $bytes "$WORK/clean"
+  $OCRNOISE $NOISE_OPTS "$WORK/clean" "$dict" > "$WORK/noisy" || exit 1
+
+  for matcher in lev sim ocr; do
+    startup=$($OCRNOISE run /dev/null $AUTOSPELL --matcher $matcher $AUTOSPELL_OPTS "$WORK/empty" "$dict") || exit 1
+    timing=$($OCRNOISE run "$WORK/corrected" $AUTOSPELL --matcher $matcher $AUTOSPELL_OPTS "$WORK/noisy" "$dict") || exit 1
+    scores=$($OCRNOISE score "$WORK/clean" "$WORK/noisy" "$WORK/corrected") || exit 1
+    seconds=$(echo "$timing" | member seconds)
+    words=$(echo "$scores" | member words)
+    echo "{ \"size_mb\": $size, \"matcher\": \"$matcher\", $(echo "$timing" | members)," \
+         "\"startup_seconds\": $(echo "$startup" | member seconds)," \
+         "$(awk -v w="$words" -v b="$bytes" -v s="$seconds" \
+              'BEGIN { if (s <= 0) s = 0.001; printf "\"words_per_sec\": %.0f, \"mb_per_sec\": %.2f", w / s, b / 1048576 / s }')," \
+         "$(echo "$scores" | members) }"
+  done
+done
@@ -0,0 +1,394 @@
+#define AUTOSPELL_NO_MAIN
+#include "../autoSpell.c"
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+/*  -=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+    ocrNoise - makes ocr-like errors in a clean text and scores how well autoSpell corrects them
+
+usage: ocrNoise [-s rate] [-t rate] [-p rate] [-n minChars] [-r seed] clean_text dictionary > noisy_text
+       ocrNoise score clean_text noisy_text corrected_text
+       ocrNoise run output_file command [argument ...]
+
+build: cc -O2 -pthread -o ocrNoise bench/ocrNoise.c
+
+The first form copies clean_text to standard output with errors put in some of its words.  Only words of at least
+minChars characters (default 7, the lev matcher's minCharWord) that are in the dictionary are changed, each at
+most once, so every error is one autoSpell could correct.  For each such word one of:
+
+-s rate   (default 0.02) a letter replaced by another letter
+-t rate   (default 0.01) two adjacent different letters swapped
+-p rate   (default 0.02) a letter replaced by the two the ocr program often makes of it: u -> tt, h -> li,
+          m -> rn, d -> cl, w -> vv (decernamus -> decernamtts); a word without any of these is left alone
+
+The rates are the chances per word and their sum must be at most 1.  -r sets the seed (default 1); the same seed
+and text always give the same errors.  The words are found as autoSpell finds them (nextToken and DELIMITERS) and
+the delimiters are never changed, so word k of every line is the same word in all three texts given to score.
+
+score compares the three texts word by word and prints one line of JSON: the number of words, of words the
+noise changed ("injected"), of words autoSpell changed ("changed") and of those it changed back to the clean word
+("right"), of clean words it changed ("damaged"), and precision = right / changed and recall = right / injected.
+Lines whose word counts differ (which autoSpell never makes) are counted as "misaligned" and skipped.
+
+run runs command with its standard output in output_file and prints one line of JSON: the wall clock "seconds",
+the peak resident memory of the command "max_rss_kb" and its exit status "exit" (autoSpell's number of
+corrections modulo 256).
+
+bench/ocrBench.sh puts the three together over texts of several sizes.
+-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= */
+
+static unsigned long long rngState;
+
+static const char *splits[][2] = { { "u", "tt" }, { "h", "li" }, { "m", "rn" }, { "d", "cl" }, { "w", "vv" } };
+
+#define NUM_SPLITS ( (int) ( sizeof( splits ) / sizeof( splits[0] ) ) )
+
+/***************************** function rng ******************************/
+
+static double rng ( void )
+{
+   // function to return a pseudo random number in [0, 1) (xorshift64*), the same on every machine for a seed
+
+   rngState ^= rngState >> 12;
+   rngState ^= rngState << 25;
+   rngState ^= rngState >> 27;
+   return (double) ( ( rngState * 2685821657736338717ULL ) >> 11 ) / 9007199254740992.0;
+}
+
+/***************************** function inDictionary ******************************/
+
+static const struct dictionary *sortedDict;     // for wordCmp
+
+static int wordCmp ( const void *a, const void *b )
+{
+   return strcmp( dictWord( sortedDict, *(const long int *) a ), dictWord( sortedDict, *(const long int *) b ) );
+}
+
+static _Bool inDictionary ( const struct dictionary *dict, const long int *sorted, const char *word )
+{
+   // function to return true if word is in dict; sorted holds the indexes of its words in strcmp order
+
+   long int lo = 0, hi = dict->numWords - 1, mid;
+   int c;
+
+   while ( lo <= hi )
+   {
+      mid = lo + ( hi - lo ) / 2;
+      if ( ( c = strcmp( word, dictWord( dict, sorted[mid] ) ) ) == 0 )
+         return (_Bool) 1;
+      if ( c < 0 )
+         hi = mid - 1;
+      else
+         lo = mid + 1;
+   }
+   return (_Bool) 0;
+}
+
+/***************************** function addNoise ******************************/
+
+static int addNoise ( const char *word, const int len, char *noisy, const double rates[3] )
+{
+   /* function to write to noisy (room for MAXL + 2 characters) word (of len characters, at most MAXL) with one error
+      chosen by rates (substitution, transposition, split) or none.  Returns the length of noisy. */
+
+   double u = rng();
+   int j, k, tries, n = 0;
+   int at[MAXL];
+
+   memcpy( noisy, word, (size_t) len );
+   if ( u < rates[0] )                                       // a letter replaced by another
+   {
+      for ( j = 0; j < len; j++ )
+         if ( isalpha( (unsigned char) word[j] ) )
+            at[n++] = j;
+      if ( n )
+      {
+         j = at[(int) ( rng() * n )];
+         k = tolower( (unsigned char) word[j] ) - 'a';
+         k = ( k >= 0 && k < 26 ? k + 1 + (int) ( rng() * 25 ) : (int) ( rng() * 26 ) ) % 26;
+         noisy[j] = (char) ( isupper( (unsigned char) word[j] ) ? 'A' + k : 'a' + k );
+      }
+   }
+   else if ( u < rates[0] + rates[1] )                       // two adjacent letters swapped
+   {
+      for ( tries = 0; tries < 4 * len; tries++ )
+      {
+         j = (int) ( rng() * ( len - 1 ) );
+         if ( word[j] != word[j + 1] && isalpha( (unsigned char) word[j] ) && isalpha( (unsigned char) word[j + 1] ) )
+         {
+            noisy[j] = word[j + 1];
+            noisy[j + 1] = word[j];
+            break;
+         }
+      }
+   }
+   else if ( u < rates[0] + rates[1] + rates[2] )            // one letter read as two
+   {
+      for ( j = 0; j < len; j++ )
+         for ( k = 0; k < NUM_SPLITS; k++ )
+            if ( word[j] == splits[k][0][0] )
+               at[n++] = j * NUM_SPLITS + k;
+      if ( n )
+      {
+         n = at[(int) ( rng() * n )];
+         j = n / NUM_SPLITS;
+         k = n % NUM_SPLITS;
+         noisy[j] = splits[k][1][0];
+         noisy[j + 1] = splits[k][1][1];
+         memcpy( noisy + j + 2, word + j + 1, (size_t) ( len - j - 1 ) );
+         return len + 1;
+      }
+   }
+   return len;
+}
+
+/***************************** function makeNoise ******************************/
+
+static int makeNoise ( FILE *text, const struct dictionary *dict, const int minChars, const double rates[3] )
+{
+   // function to copy text to standard output with errors in some of its words.  Returns 0 or -4 if memory ran out
+
+   unsigned char delimTable[256];
+   struct tokenSpan span;
+   long int *sorted;
+   long int i;
+   char *line = NULL;
+   size_t len = 0, cursor;
+   ssize_t read;
+   char word[MAXL + 1], noisy[MAXL + 2];
+   int n;
+
+   if ( ( sorted = malloc( (size_t) ( dict->numWords + 1 ) * sizeof( *sorted ) ) ) == NULL )
+      return -4;
+   for ( i = 0; i < dict->numWords; i++ )
+      sorted[i] = i;
+   sortedDict = dict;
+   qsort( sorted, (size_t) dict->numWords, sizeof( *sorted ), wordCmp );
+   makeDelimTable( delimTable, DELIMITERS );
+
+   while ( ( read = getline( &line, &len, text ) ) != -1 )
+   {
+      cursor = 0;
+      while ( nextToken( delimTable, line, (size_t) read, &cursor, &span ) )
+      {
+         n = (int) span.length;
+         if ( !span.isWord || n < minChars || n > MAXL )
+         {
+            fwrite( line + span.offset, 1, span.length, stdout );
+            continue;
+         }
+         memcpy( word, line + span.offset, (size_t) n );
+         word[n] = '\0';
+         word[0] = (char) tolower( (unsigned char) word[0] );      // as returnWord looks it up
+         if ( inDictionary( dict, sorted, word ) )
+         {
+            n = addNoise( line + span.offset, n, noisy, rates );
+            fwrite( noisy, 1, (size_t) n, stdout );
+         }
+         else
+            fwrite( line + span.offset, 1, span.length, stdout );
+      }
+   }
+   free( line );
+   free( sorted );
+   return 0;
+}
+
+/***************************** function score ******************************/
+
+static int score ( FILE *text[3] )
+{
+   /* function to compare the clean, noisy and corrected texts word by word and print the counts as JSON.
+      Returns 0, or -5 if the texts do not have the same number of lines */
+
+   unsigned char delimTable[256];
+   struct tokenSpan span[3];
+   char *line[3] = { NULL, NULL, NULL };
+   size_t len[3] = { 0, 0, 0 }, cursor[3];
+   ssize_t read[3];
+   long int words = 0, injected = 0, changed = 0, right = 0, damaged = 0, misaligned = 0;
+   _Bool more[3];
+   int f, rc = 0;
+
+   makeDelimTable( delimTable, DELIMITERS );
+   while ( 1 )
+   {
+      for ( f = 0; f < 3; f++ )
+         read[f] = getline( &line[f], &len[f], text[f] );
+      if ( read[0] == -1 || read[1] == -1 || read[2] == -1 )
+      {
+         if ( read[0] != -1 || read[1] != -1 || read[2] != -1 )
+            rc = -5;
+         break;
+      }
+      cursor[0] = cursor[1] = cursor[2] = 0;
+      while ( 1 )                                            // the words of the line, side by side
+      {
+         for ( f = 0; f < 3; f++ )
+            while ( ( more[f] = nextToken( delimTable, line[f], (size_t) read[f], &cursor[f], &span[f] ) )
+                    && !span[f].isWord )
+               ;
+         if ( !more[0] || !more[1] || !more[2] )
+         {
+            if ( more[0] || more[1] || more[2] )
+               misaligned++;
+            break;
+         }
+#define SAME( a, b ) ( span[a].length == span[b].length \
+                       && memcmp( line[a] + span[a].offset, line[b] + span[b].offset, span[a].length ) == 0 )
+         words++;
+         if ( !SAME( 0, 1 ) )
+            injected++;
+         if ( !SAME( 1, 2 ) )
+         {
+            changed++;
+            if ( SAME( 0, 2 ) )
+               right++;
+            else if ( SAME( 0, 1 ) )
+               damaged++;
+         }
+#undef SAME
+      }
+   }
+   printf( "{ \"words\": %ld, \"injected\": %ld, \"changed\": %ld, \"right\": %ld, \"damaged\": %ld, "
+           "\"misaligned\": %ld, \"precision\": %.4f, \"recall\": %.4f }\n", words, injected, changed, right, damaged,
+           misaligned, changed ? (double) right / changed : 1.0, injected ? (double) right / injected : 1.0 );
+   for ( f = 0; f < 3; f++ )
+      free( line[f] );
+   return rc;
+}
+
+/***************************** function run ******************************/
+
+static int run ( const char *outputPath, char *command[] )
+{
+   /* function to run command with its standard output in outputPath and print its wall clock time, peak resident
+      memory and exit status as JSON.  Returns 0, or -6 if the command could not be started */
+
+   struct timespec t0, t1;
+   struct rusage usage;
+   pid_t pid;
+   int status, fd;
+
+   if ( ( fd = open( outputPath, O_WRONLY | O_CREAT | O_TRUNC, 0644 ) ) < 0 )
+   {
+      fprintf (stderr, "cannot write the output file %s\n", outputPath);
+      return -6;
+   }
+   clock_gettime( CLOCK_MONOTONIC, &t0 );
+   if ( ( pid = fork() ) == 0 )
+   {
+      dup2( fd, STDOUT_FILENO );
+      execvp( command[0], command );
+      fprintf (stderr, "cannot run %s\n", command[0]);
+      _exit( 127 );
+   }
+   close( fd );
+   if ( pid < 0 || wait4( pid, &status, 0, &usage ) != pid )
+   {
+      fprintf (stderr, "cannot run %s\n", command[0]);
+      return -6;
+   }
+   clock_gettime( CLOCK_MONOTONIC, &t1 );
+   printf( "{ \"seconds\": %.3f, \"max_rss_kb\": %ld, \"exit\": %d }\n",
+           (double) ( t1.tv_sec - t0.tv_sec ) + (double) ( t1.tv_nsec - t0.tv_nsec ) / 1e9, usage.ru_maxrss,
+           WIFEXITED( status ) ? WEXITSTATUS( status ) : -1 );
+   return WIFEXITED( status ) && WEXITSTATUS( status ) == 127 ? -6 : 0;
+}
+
+/***************************** function usage ******************************/
+
+static int usage ( void )
+{
+   fprintf (stderr, "usage: ocrNoise [-s rate] [-t rate] [-p rate] [-n minChars] [-r seed] clean_text dictionary > noisy_text\n"
+                    "       ocrNoise score clean_text noisy_text corrected_text\n"
+                    "       ocrNoise run output_file command [argument ...]\n");
+   return -1;
+}
+
+/***************************************** main **********************************************/
+
+int main ( int argc, char *argv[] )
+{
+   struct dictionary dict = { 0 };
+   long int wordLenIndex[MAXL + 2] = { 0 };
+   size_t lastWordSize = 0;
+   unsigned long long dictHash = 14695981039346656037ULL;
+   unsigned long long seed = 1;
+   double rates[3] = { 0.02, 0.01, 0.02 };
+   FILE *text[3];
+   FILE *wordList;
+   int minChars = 7;
+   int opt, f, rc;
+
+   if ( argc >= 2 && strcmp( argv[1], "score" ) == 0 )
+   {
+      if ( argc != 5 )
+         return usage();
+      for ( f = 0; f < 3; f++ )
+         if ( ( text[f] = fopen( argv[f + 2], "r" ) ) == NULL )
+         {
+            fprintf (stderr, "cannot read the input text file %s\n", argv[f + 2]);
+            return -2;
+         }
+      if ( ( rc = score( text ) ) != 0 )
+         fprintf (stderr, "the texts do not have the same number of lines\n");
+      for ( f = 0; f < 3; f++ )
+         fclose( text[f] );
+      return rc;
+   }
+   if ( argc >= 2 && strcmp( argv[1], "run" ) == 0 )
+   {
+      if ( argc < 4 )
+         return usage();
+      return run( argv[2], argv + 3 );
+   }
+
+   while ( ( opt = getopt( argc, argv, "s:t:p:n:r:" ) ) != -1 )
+   {
+      if ( opt == 's' )
+         rates[0] = atof( optarg );
+      else if ( opt == 't' )
+         rates[1] = atof( optarg );
+      else if ( opt == 'p' )
+         rates[2] = atof( optarg );
+      else if ( opt == 'n' && ( minChars = atoi( optarg ) ) >= 2 )
+         ;
+      else if ( opt == 'r' )
+         seed = strtoull( optarg, NULL, 10 );
+      else
+         return usage();
+   }
+   if ( argc - optind != 2 || rates[0] < 0 || rates[1] < 0 || rates[2] < 0 || rates[0] + rates[1] + rates[2] > 1 )
+      return usage();
+   rngState = seed * 0x9e3779b97f4a7c15ULL + 1;              // never 0, which xorshift would keep
+
+   if ( ( text[0] = fopen( argv[optind], "r" ) ) == NULL )
+   {
+      fprintf (stderr, "cannot read the input text file %s\n", argv[optind]);
+      return -2;
+   }
+   if ( ( wordList = fopen( argv[optind + 1], "r" ) ) == NULL )
+   {
+      fprintf (stderr, "cannot read the input dictionary %s\n", argv[optind + 1]);
+      return -3;
+   }
+   rc = (int) readWordList( wordList, &dict, wordLenIndex, &lastWordSize, &dictHash );
+   fclose( wordList );
+   if ( rc == -1 )
+      fprintf (stderr, "the input dictionary is not properly sorted\n");
+   else if ( rc == -3 )
+      fprintf (stderr, "the input dictionary has more than %d different non-ASCII characters\n",
+               NARROW_OTHER - NARROW_FIRST);
+   else if ( rc == -2 || ( rc = makeNoise( text[0], &dict, minChars, rates ) ) != 0 )
+   {
+      fprintf (stderr, "cannot allocate memory for the dictionary\n");
+      rc = -4;
+   }
+   fclose( text[0] );
+   free( dict.arena );
+   free( dict.offset );
+   free( dict.freq );
+   return rc == -1 || rc == -3 ? -3 : rc;
+}
@@ -0,0 +1,294 @@
+#define AUTOSPELL_NO_MAIN
+#include "../autoSpell.c"
+
+/*  -=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=
+
+    simWordsDiff - checks simWords against the function it replaced
+
+usage: simWordsDiff [-n pairs] [-s seed]
+
+build: cc -O2 -pthread -o simWordsDiff bench/simWordsDiff.c
+
+simWords decides from the common prefix and suffix of the two words what the earlier version (kept below as
+oldSimWords) found by blanking out every single character and pair of adjacent characters and comparing the copies.
+This program runs both on:
+
+   every test word of 1 to 7 letters over the alphabet abc against every true word of the same length or one
+   letter shorter (7.2 million pairs, every way two short words can agree and differ);
+   pairs random words of 1 to MAXL - 1 letters over the alphabet abcd (default 20 000 000, seed -s, default 1),
+   the test word being the true word with up to 3 letters substituted (the second one often next to the first)
+   and one letter inserted or deleted or neither.
+
+It prints the number of pairs compared and of each result to standard output and the first few pairs on which the
+two differ to standard error, and returns 0 if they always agree, 1 if not and -1 on a usage error.
+-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-= */
+
+#define SWEEP_LEN 7               // longest test word of the exhaustive sweep
+#define MAX_REPORTED 10           // mismatches printed
+
+static unsigned long long rngState;
+static long int pairs, mismatches;
+static long int results[3];
+
+/***************************** function rng ******************************/
+
+static unsigned long int rng ( const unsigned long int n )
+{
+   // function to return a pseudo random number in 0..n-1 (xorshift64*), the same on every machine for a seed
+
+   rngState ^= rngState >> 12;
+   rngState ^= rngState << 25;
+   rngState ^= rngState >> 27;
+   return (unsigned long int) ( ( rngState * 2685821657736338717ULL ) >> 33 ) % n;
+}
+
+/***************************** function oldSimWords ******************************/
+
+static int oldSimWords (const char *testWord, const char *trueWord)
+
+/*
+   simWords as it was before the O(L) kernel, kept as the reference.  The one change: NtestWord and NtrueWord
+   start one place into their buffers, since for words of 1 character the old code wrote NtestWord[-1] and
+   NtrueWord[-1] (it never read them, so the results are those of the old function).
+*/
+
+{
+int j,k;
+int result = 0;
+int len_testWord = (int) strlen(testWord);
+int len_trueWord = (int) strlen(trueWord);
+char testBuffer[len_testWord + 2];
+char trueBuffer[len_trueWord + 2];
+char *NtestWord = testBuffer + 1;
+char *NtrueWord = trueBuffer + 1;
+int diffchar = len_testWord - len_trueWord;
+
+if ( strcmp (trueWord, testWord) == 0) //words are identical
+   result = 2;
+else if (diffchar == 0) //e.g. constarc vs. constare
+{
+   j=0;
+   NtestWord[len_testWord - 1] = '\0';
+   NtrueWord[len_trueWord - 1] = '\0';
+   //blank out corresponding single characters positions from each word and compare
+   while (result == 0 && j < len_testWord )
+   {
+      k=0;
+      while (k < len_testWord) //build the new "word"
+      {
+         if (k < j)
+         {
+            NtestWord[k] = testWord[k];
+            NtrueWord[k] = trueWord[k];
+         }
+         if (k >= j)
+         {
+            NtestWord[k] = testWord[k + 1];
+            NtrueWord[k] = trueWord[k + 1];
+         }
+         k++;
+      } //end while k
+      j++;
+      if ( strcmp (NtrueWord, NtestWord) == 0)
+         result = 1;
+   }
+   NtestWord[len_testWord - 2] = '\0';
+   NtrueWord[len_trueWord - 2] = '\0';
+   j=0;
+   //blank out corresponding pairs of character positions from each word and compare
+   while ( result == 0 && j < len_testWord - 1 )
+   {
+      k=0;
+      while (k < len_testWord - 1) //build the new "word"
+      {
+         if (k < j)
+         {
+            NtestWord[k] = testWord[k];
+            NtrueWord[k] = trueWord[k];
+         }
+         if (k >= j)
+         {
+            NtestWord[k] = testWord[k + 2];
+            NtrueWord[k] = trueWord[k + 2];
+            if (k + 3 < len_testWord)
+            {
+               NtestWord[k + 1] = testWord[k + 3];
+               NtrueWord[k + 1] = testWord[k + 3];
+            }
+         }
+         k++;
+      } //end of while k
+      j++;
+      if ( strcmp (NtrueWord, NtestWord) == 0)
+         result = 1;
+   } //end of while j
+}
+else if (diffchar == 1)
+//testWord is one character longer than trueWord e.g. decernamtts vs. decernamus
+   {
+   NtestWord[len_testWord - 2] = '\0';
+   NtrueWord[len_trueWord - 1] = '\0';
+   j=0;
+   //blank out adjacent pairs of characters from testWord while blanking out corresonding single character from trueWord
+   while ( result == 0 && j < len_testWord - 1 )         // the last pair starts at len_testWord - 2
+   {
+      k=0;
+      while (k < len_testWord) //build the new "word"
+      {
+         if (k < j)
+         {
+            NtestWord[k] = testWord[k];
+            NtrueWord[k] = trueWord[k];
+         }
+         if (k >= j)
+         {
+            if (k + 2 < len_testWord)
+               NtestWord[k] = testWord[k + 2];
+            if (k + 3 < len_testWord)
+               NtestWord[k + 1] = testWord[k + 3];
+            if (k < len_trueWord)                       // NtrueWord has len_trueWord places
+               NtrueWord[k] = trueWord[k + 1];
+         }
+         k++;
+      } //end of while k
+      j++;
+      if ( strcmp (NtrueWord, NtestWord) == 0)
+         result = 1;
+   } //end of while j
+
+}
+return result;
+}
+
+/***************************** function compare ******************************/
+
+static void compare ( const char *testWord, const char *trueWord )
+{
+   // function to run both functions on one pair and count the result, printing it if they differ
+
+   int expected = oldSimWords( testWord, trueWord );
+   int got = simWords( testWord, trueWord );
+
+   pairs++;
+   results[expected]++;
+   if ( got != expected && mismatches++ < MAX_REPORTED )
+      fprintf (stderr, "simWords( \"%s\", \"%s\" ) = %d, the old function gave %d\n", testWord, trueWord, got, expected);
+}
+
+/***************************** function nextWord ******************************/
+
+static _Bool nextWord ( char *word, const int len )
+{
+   // function to make word (len letters of abc) the next one in alphabetical order; false after ccc...c
+
+   int k;
+
+   for ( k = len - 1; k >= 0 && word[k] == 'c'; k-- )
+      word[k] = 'a';
+   if ( k < 0 )
+      return (_Bool) 0;
+   word[k]++;
+   return (_Bool) 1;
+}
+
+/***************************** function sweep ******************************/
+
+static void sweep ( void )
+{
+   // function to compare every test word of 1..SWEEP_LEN letters of abc with every true word as long or one shorter
+
+   char testWord[SWEEP_LEN + 1], trueWord[SWEEP_LEN + 1];
+   int len, trueLen;
+
+   for ( len = 1; len <= SWEEP_LEN; len++ )
+   {
+      memset( testWord, 'a', (size_t) len );
+      testWord[len] = '\0';
+      do
+         for ( trueLen = len - 1; trueLen <= len; trueLen++ )
+         {
+            memset( trueWord, 'a', (size_t) trueLen );
+            trueWord[trueLen] = '\0';
+            do
+               compare( testWord, trueWord );
+            while ( nextWord( trueWord, trueLen ) );
+         }
+      while ( nextWord( testWord, len ) );
+   }
+}
+
+/***************************** function randomPairs ******************************/
+
+static void randomPairs ( const long int numPairs )
+{
+   // function to compare numPairs random true words with test words made from them by a few edits
+
+   char trueWord[MAXL + 1], testWord[MAXL + 2];
+   int len, testLen, edits, e, j;
+   long int n;
+
+   for ( n = 0; n < numPairs; n++ )
+   {
+      len = 1 + (int) rng( MAXL - 1 );
+      for ( j = 0; j < len; j++ )
+         trueWord[j] = (char) ( 'a' + rng( 4 ) );
+      trueWord[len] = '\0';
+      memcpy( testWord, trueWord, (size_t) len + 1 );
+      edits = (int) rng( 4 );
+      for ( e = 0, j = (int) rng( (unsigned long int) len ); e < edits; e++ )
+      {
+         if ( e > 0 )
+            j = rng( 2 ) ? j + 1 : (int) rng( (unsigned long int) len );   // often the pair j, j+1
+         if ( j < len )
+            testWord[j] = (char) ( 'a' + ( testWord[j] - 'a' + 1 + (int) rng( 3 ) ) % 4 );
+      }
+      testLen = len;
+      switch ( rng( 3 ) )
+      {
+         case 0:                                             // a letter inserted: test one longer
+            j = (int) rng( (unsigned long int) len + 1 );
+            memmove( testWord + j + 1, testWord + j, (size_t) ( len - j ) + 1 );
+            testWord[j] = (char) ( 'a' + rng( 4 ) );
+            testLen++;
+            break;
+         case 1:                                             // a letter deleted: test one shorter
+            j = (int) rng( (unsigned long int) len );
+            memmove( testWord + j, testWord + j + 1, (size_t) ( len - j ) );
+            testLen--;
+            break;
+         default:
+            break;
+      }
+      if ( testLen >= 1 )
+         compare( testWord, trueWord );
+   }
+}
+
+int main ( int argc, char *argv[] )
+{
+   long int numPairs = 20000000;
+   unsigned long long seed = 1;
+   int opt;
+
+   while ( ( opt = getopt( argc, argv, "n:s:" ) ) != -1 )
+   {
+      if ( opt == 'n' && ( numPairs = atol( optarg ) ) >= 0 )
+         ;
+      else if ( opt == 's' )
+         seed = strtoull( optarg, NULL, 10 );
+      else
+         break;
+   }
+   if ( opt != -1 || optind != argc )
+   {
+      fprintf (stderr, "usage: simWordsDiff [-n pairs] [-s seed]\n");
+      return -1;
+   }
+   rngState = seed * 0x9e3779b97f4a7c15ULL + 1;              // never 0, which xorshift would keep
+
+   sweep();
+   randomPairs( numPairs );
+   printf( "pairs %ld  not similar %ld  similar %ld  identical %ld  mismatches %ld\n",
+           pairs, results[0], results[1], results[2], mismatches );
+   return mismatches ? 1 : 0;
+}